@@ -0,0 +1,71 @@
+#include "stdafx.h"
+#include "ECompactGraph.h"
+#include "EGraph.h"
+#include "EGraphConnection.h"
+
+using namespace Elite;
+
+struct CompactGraph::OwnedArrays
+{
+	std::vector<int> connectionOffsets{};
+	std::vector<int> connectionTargets{};
+	std::vector<float> connectionCosts{};
+	std::vector<Vector2> nodePositions{};
+	std::vector<unsigned char> isNodeValid{};
+	std::vector<GraphNode*> pNodes{};
+};
+
+CompactGraph::CompactGraph(const Graph& graph, bool keepNodes)
+	: m_IsDirectional{ graph.IsDirectional() }
+	, m_NrOfNodeSlots{ graph.GetNrOfNodeSlots() }
+	, m_AmountNodes{ graph.GetAmountOfNodes() }
+	, m_Version{ graph.GetVersion() }
+{
+	std::shared_ptr<OwnedArrays> pOwnedArrays = std::make_shared<OwnedArrays>();
+
+	pOwnedArrays->connectionOffsets.reserve(m_NrOfNodeSlots + 1);
+	pOwnedArrays->connectionTargets.reserve(graph.GetAmountOfConnections());
+	pOwnedArrays->connectionCosts.reserve(graph.GetAmountOfConnections());
+	pOwnedArrays->nodePositions.resize(m_NrOfNodeSlots);
+	pOwnedArrays->isNodeValid.resize(m_NrOfNodeSlots, 0);
+	if (keepNodes)
+		pOwnedArrays->pNodes.resize(m_NrOfNodeSlots, nullptr);
+
+	pOwnedArrays->connectionOffsets.push_back(0);
+	for (int nodeId = 0; nodeId < m_NrOfNodeSlots; ++nodeId)
+	{
+		if (graph.IsNodeValid(nodeId))
+		{
+			pOwnedArrays->isNodeValid[nodeId] = 1;
+			if (keepNodes)
+				pOwnedArrays->pNodes[nodeId] = graph.GetNode(nodeId);
+			pOwnedArrays->nodePositions[nodeId] = graph.GetNodePos(nodeId);
+
+			for (const GraphConnection* const pConnection : graph.GetConnectionsFromNode(nodeId))
+			{
+				pOwnedArrays->connectionTargets.push_back(pConnection->GetToNodeId());
+				pOwnedArrays->connectionCosts.push_back(pConnection->GetCost());
+			}
+		}
+		pOwnedArrays->connectionOffsets.push_back(static_cast<int>(pOwnedArrays->connectionTargets.size()));
+	}
+
+	m_NrOfConnections = static_cast<int>(pOwnedArrays->connectionTargets.size());
+	m_Arrays.pConnectionOffsets = pOwnedArrays->connectionOffsets.data();
+	m_Arrays.pConnectionTargets = pOwnedArrays->connectionTargets.data();
+	m_Arrays.pConnectionCosts = pOwnedArrays->connectionCosts.data();
+	m_Arrays.pNodePositions = pOwnedArrays->nodePositions.data();
+	m_Arrays.pIsNodeValid = pOwnedArrays->isNodeValid.data();
+	m_ppNodes = keepNodes ? pOwnedArrays->pNodes.data() : nullptr;
+	m_pStorage = std::move(pOwnedArrays);
+}
+
+CompactGraph::CompactGraph(bool isDirectional, int nrOfNodeSlots, int amountNodes, int nrOfConnections, const ArrayView& arrays, std::shared_ptr<const void> pStorage)
+	: m_IsDirectional{ isDirectional }
+	, m_NrOfNodeSlots{ nrOfNodeSlots }
+	, m_AmountNodes{ amountNodes }
+	, m_NrOfConnections{ nrOfConnections }
+	, m_Arrays{ arrays }
+	, m_pStorage{ std::move(pStorage) }
+{
+}
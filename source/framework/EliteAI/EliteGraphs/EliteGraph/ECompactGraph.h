@@ -0,0 +1,77 @@
+//*=================================================*/
+// ECompactGraph.h: Read-only snapshot of a Graph, with the adjacency stored in flat
+// (compressed sparse row) arrays so searches don't have to chase connection pointers
+//*=================================================*/
+
+#pragma once
+#include <memory>
+#include "EGraphNode.h"
+
+namespace Elite
+{
+	class Graph;
+
+	class CompactGraph final
+	{
+	public:
+		// Flat arrays that are owned by something else, e.g. a memory-mapped graph file
+		struct ArrayView
+		{
+			const int* pConnectionOffsets = nullptr; // nrOfNodeSlots + 1 entries
+			const int* pConnectionTargets = nullptr;
+			const float* pConnectionCosts = nullptr;
+			const Vector2* pNodePositions = nullptr;
+			const unsigned char* pIsNodeValid = nullptr;
+			const int* pNodeTerrainTypes = nullptr; // optional
+			const int* pNodeLineIndices = nullptr; // optional
+		};
+
+		CompactGraph() = default;
+		// Without keepNodes GetNode always returns nullptr, for snapshots that outlive the nodes or are read on other threads
+		explicit CompactGraph(const Graph& graph, bool keepNodes = true);
+		// pStorage keeps the arrays alive for as long as this graph (or a copy of it) exists
+		CompactGraph(bool isDirectional, int nrOfNodeSlots, int amountNodes, int nrOfConnections, const ArrayView& arrays, std::shared_ptr<const void> pStorage);
+
+		//Graph properties
+		bool IsDirectional() const { return m_IsDirectional; }
+		int GetNrOfNodeSlots() const { return m_NrOfNodeSlots; }
+		int GetAmountOfNodes() const { return m_AmountNodes; }
+		int GetAmountOfConnections() const { return m_NrOfConnections; }
+		// Version of the source graph this was built from, 0 for graphs loaded from a file
+		unsigned long long GetVersion() const { return m_Version; }
+
+		//Nodes (ids are the same as in the source graph, removed ids are kept as empty slots)
+		bool IsNodeValid(int nodeId) const { return (unsigned int)nodeId < (unsigned int)m_NrOfNodeSlots && m_Arrays.pIsNodeValid[nodeId] != 0; }
+		// Only safe to dereference as long as the source graph did not remove the node, always nullptr for graphs loaded from a file
+		GraphNode* GetNode(int nodeId) const { return IsNodeValid(nodeId) && m_ppNodes != nullptr ? m_ppNodes[nodeId] : nullptr; }
+		const Vector2& GetNodePos(int nodeId) const { return m_Arrays.pNodePositions[nodeId]; }
+
+		// Only filled in for graphs loaded from a file, use GetNode otherwise
+		bool HasTerrainTypes() const { return m_Arrays.pNodeTerrainTypes != nullptr; }
+		TerrainType GetNodeTerrainType(int nodeId) const { return static_cast<TerrainType>(m_Arrays.pNodeTerrainTypes[nodeId]); }
+		bool HasLineIndices() const { return m_Arrays.pNodeLineIndices != nullptr; }
+		int GetNodeLineIndex(int nodeId) const { return m_Arrays.pNodeLineIndices[nodeId]; }
+
+		//Connections of a node are the range [GetConnectionsBegin, GetConnectionsEnd)
+		int GetConnectionsBegin(int nodeId) const { return m_Arrays.pConnectionOffsets[nodeId]; }
+		int GetConnectionsEnd(int nodeId) const { return m_Arrays.pConnectionOffsets[nodeId + 1]; }
+		int GetDegree(int nodeId) const { return GetConnectionsEnd(nodeId) - GetConnectionsBegin(nodeId); }
+		int GetConnectionTarget(int connectionIdx) const { return m_Arrays.pConnectionTargets[connectionIdx]; }
+		float GetConnectionCost(int connectionIdx) const { return m_Arrays.pConnectionCosts[connectionIdx]; }
+
+		const ArrayView& GetArrays() const { return m_Arrays; }
+
+	private:
+		struct OwnedArrays;
+
+		bool m_IsDirectional{ false };
+		int m_NrOfNodeSlots{ 0 };
+		int m_AmountNodes{ 0 };
+		int m_NrOfConnections{ 0 };
+		unsigned long long m_Version{ 0 };
+
+		ArrayView m_Arrays{};
+		GraphNode* const* m_ppNodes = nullptr;
+		std::shared_ptr<const void> m_pStorage{}; // owns everything the pointers above point to, shared between copies
+	};
+}
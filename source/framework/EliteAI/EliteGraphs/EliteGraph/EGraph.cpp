@@ -2,15 +2,18 @@
 #include "EGraph.h"
 #include "EGraphNode.h"
 #include "EGraphConnection.h"
+#include "ECompactGraph.h"
+#include "EGraphSpatialIndex.h"
 
 using namespace Elite;
 
-Graph::Graph(bool isDirectional, GraphNodeFactory* const pNodeFactory)
+Graph::Graph(bool isDirectional, GraphNodeFactory* const pNodeFactory, GraphConnectionFactory* const pConnectionFactory)
 	:m_isDirectional{ isDirectional }
 	, m_nextNodeId{ 0 }
 	, m_pNodes{}
 	, m_pConnections{}
 	,m_pNodeFactory{pNodeFactory}
+	,m_pConnectionFactory{ pConnectionFactory != nullptr ? pConnectionFactory : new GraphConnectionFactory() }
 {
 }
 
@@ -23,12 +26,12 @@ Graph::Graph(const Graph& other)
 	, m_nextNodeId{ other.m_nextNodeId }
 	, m_isDirectional{ other.m_isDirectional }
 	, m_pNodeFactory{ other.m_pNodeFactory }
+	, m_pConnectionFactory{ other.m_pConnectionFactory }
+	, m_TrackIncomingConnections{ other.m_TrackIncomingConnections }
+	, m_ChangeJournal{ other.m_ChangeJournal.GetCapacity(), other.m_ChangeJournal.GetVersion() }
 {
-	for (std::vector<Elite::GraphConnection*>& connectionList : m_pConnections)
-	{
-		for (Elite::GraphConnection* pConnection : connectionList)
-			SAFE_DELETE(pConnection);
-	}
+	m_pNodes.reserve(other.m_pNodes.size());
+	m_pConnections.reserve(other.m_pConnections.size());
 
 	for (Elite::GraphNode* pNode : other.m_pNodes)
 	{
@@ -45,13 +48,19 @@ Graph::Graph(const Graph& other)
 	for (const std::vector<Elite::GraphConnection*>& connectionList : other.m_pConnections)
 	{
 		std::vector<GraphConnection*> newList;
+		newList.reserve(connectionList.size());
 		for (const Elite::GraphConnection* pConnection : connectionList)
-			newList.push_back(new GraphConnection(*pConnection));
-		m_pConnections.push_back(newList);
+			newList.push_back(CloneConnection(*pConnection));
+		m_pConnections.push_back(std::move(newList));
 	}
 
-	UpdateNextNodeIndex();
-	UpdateActiveNodes();
+	RebuildNodeBookkeeping();
+	RebuildIncomingConnections();
+
+	if (other.m_pSpatialIndex != nullptr)
+		EnableSpatialIndex(other.m_pSpatialIndex->GetCellSize());
+	else if (other.m_SuspendedSpatialIndexCellSize > 0.f)
+		EnableSpatialIndex(other.m_SuspendedSpatialIndexCellSize);
 }
 
 
@@ -64,19 +73,30 @@ Graph::~Graph()
 int Graph::AddNode(GraphNode* const pNode)
 {
 	pNode->SetId(m_nextNodeId);
-	const int size = static_cast<int>(m_pNodes.size());
-	if (size < m_nextNodeId + 1)
+	if (m_nextNodeId == static_cast<int>(m_pNodes.size()))
+	{
+		m_pNodes.push_back(nullptr);
+		m_pConnections.emplace_back();
+		if (m_TrackIncomingConnections)
+			m_pIncomingConnections.emplace_back();
+	}
+	else
 	{
-		m_pNodes.resize(m_nextNodeId + 1);
-		m_pConnections.resize(m_nextNodeId + 1);
+		// m_nextNodeId is always the last freed id when there are free ids
+		m_FreeNodeIds.pop_back();
 	}
 	m_pNodes[pNode->GetId()] = pNode;
 
 	++m_amountNodes;
 
 	UpdateNextNodeIndex();
-	UpdateActiveNodes();
+	AddActiveNode(pNode);
 
+	if (m_pSpatialIndex != nullptr)
+		m_pSpatialIndex->AddNode(pNode->GetId(), pNode->GetPosition());
+
+	m_ChangeJournal.Record(GraphChangeType::NodeAdded, pNode->GetId());
+	NotifyGraphModified(true, false);
 	return pNode->GetId();
 }
 
@@ -84,20 +104,31 @@ void Graph::Clear()
 {
 	for (Elite::GraphNode* pNode : m_pNodes)
 	{
-		SAFE_DELETE(pNode);
+		if (pNode)
+			DestroyNode(pNode);
 	}
 
 	for (std::vector<Elite::GraphConnection*>& connections : m_pConnections)
 	{
 		for (Elite::GraphConnection* pConnection : connections)
 		{
-			SAFE_DELETE(pConnection);
+			DestroyConnection(pConnection);
 		}
 		connections.clear();
 	}
 	m_pConnections.clear();
+	m_pIncomingConnections.clear();
 	m_pNodes.clear();
-	m_nextNodeId = 0;
+	m_amountNodes = 0;
+	m_amountConnections = 0;
+
+	RebuildNodeBookkeeping();
+
+	if (m_pSpatialIndex != nullptr)
+		m_pSpatialIndex->Clear();
+
+	m_ChangeJournal.Reset();
+	NotifyGraphModified(true, true);
 }
 
 GraphNode* const Graph::GetNode(int index) const
@@ -118,54 +149,28 @@ void Graph::RemoveNode(int index)
 	if (!IsNodeValid(index))
 		return;
 
+	// also removes the connections leading to the node, which directed graphs used to leave behind
+	const int nrOfConnections = m_amountConnections;
+	RemoveConnectionsWithNode(index);
+
+	// the active list still needs the id of the node
+	RemoveActiveNode(index);
+
 	GraphNode* node = m_pNodes[index];
 	node->SetId(invalid_node_id);
-	SAFE_DELETE(node);
+	DestroyNode(node);
 	m_pNodes[index] = nullptr;
 
 	--m_amountNodes;
 
-	bool hadConnections{ false };
-
-	//if the graph is not directed remove all connections leading to this pNode and then
-	//clear the connections leading from the pNode
-	if (!m_isDirectional)
-	{
-		//visit each neighbour and erase any connections leading to this pNode
-		for (auto currentConnection = m_pConnections[index].begin();
-			currentConnection != m_pConnections[index].end();
-			++currentConnection)
-		{
-			for (auto currentEdgeOnToNode = m_pConnections[(*currentConnection)->GetToNodeId()].begin();
-				currentEdgeOnToNode != m_pConnections[(*currentConnection)->GetToNodeId()].end();
-				++currentEdgeOnToNode)
-			{
-				if ((*currentEdgeOnToNode)->GetToNodeId() == index)
-				{
-					hadConnections = true;
-
-					Elite::GraphConnection* conPtr = *currentEdgeOnToNode;
-					currentEdgeOnToNode = m_pConnections[(*currentConnection)->GetToNodeId()].erase(currentEdgeOnToNode);
-					--m_amountConnections;
-					SAFE_DELETE(conPtr);
-
-					break;
-				}
-			}
-		}
-	}
+	m_FreeNodeIds.push_back(index);
+	UpdateNextNodeIndex();
 
-	//finally, clear this pNode's connections
-	for (Elite::GraphConnection* pConnection : m_pConnections[index])
-	{
-		--m_amountConnections;
-		hadConnections = true;
-		SAFE_DELETE(pConnection);
-	}
-	m_pConnections[index].clear();
+	if (m_pSpatialIndex != nullptr)
+		m_pSpatialIndex->RemoveNode(index);
 
-	UpdateNextNodeIndex();
-	UpdateActiveNodes();
+	m_ChangeJournal.Record(GraphChangeType::NodeRemoved, index);
+	NotifyGraphModified(true, nrOfConnections != m_amountConnections);
 }
 
 int Graph::GetNodeIdAtPosition(const Vector2& pos, float errorMargin) const
@@ -180,6 +185,30 @@ int Graph::GetNodeIdAtPosition(const Vector2& pos, float errorMargin) const
 GraphNode* const Graph::GetNodeAtPosition(const Vector2& position, float errorMargin) const
 {
 	const float nodeRadiusSq = DEFAULT_NODE_RADIUS * DEFAULT_NODE_RADIUS * errorMargin * errorMargin;
+
+	if (m_pSpatialIndex != nullptr)
+	{
+		std::vector<int> candidateIds{};
+		m_pSpatialIndex->QueryNodes(position, DEFAULT_NODE_RADIUS * errorMargin, candidateIds);
+
+		GraphNode* pClosestNode = nullptr;
+		float closestDistSq = nodeRadiusSq;
+		for (int nodeId : candidateIds)
+		{
+			GraphNode* const pNode = GetNode(nodeId);
+			if (pNode == nullptr)
+				continue;
+
+			const float distSq = (pNode->GetPosition() - position).MagnitudeSquared();
+			if (distSq < closestDistSq)
+			{
+				pClosestNode = pNode;
+				closestDistSq = distSq;
+			}
+		}
+		return pClosestNode;
+	}
+
 	auto foundIt = find_if(m_pActiveNodes.begin(), m_pActiveNodes.end(),
 		[position, nodeRadiusSq, this](GraphNode* pNode)
 		{
@@ -194,18 +223,8 @@ GraphNode* const Graph::GetNodeAtPosition(const Vector2& position, float errorMa
 
 void Graph::AddNodeAtIndex(GraphNode* const pNode, int index)
 {
-	pNode->SetId(m_nextNodeId);
-	if (m_pNodes.size() < (size_t)m_nextNodeId + 1)
-	{
-		m_pNodes.resize(m_nextNodeId + 1);
-		m_pConnections.resize(m_nextNodeId + 1);
-	}
-	m_pNodes[pNode->GetId()] = pNode;
-
-	++m_amountNodes;
-
-	UpdateNextNodeIndex();
-	UpdateActiveNodes();
+	// nodes are always placed at the next free id, callers use this in id order
+	AddNode(pNode);
 }
 
 const std::vector<GraphNode*>& Graph::GetAllNodes() const
@@ -219,19 +238,28 @@ void Graph::AddConnection(GraphConnection* const pConnection)
 	assert(IsNodeValid(pConnection->GetFromNodeId()) && IsNodeValid(pConnection->GetToNodeId()) && "<Graph::AddConnection>: invalid node index");
 
 	m_pConnections[pConnection->GetFromNodeId()].push_back(pConnection);
+	AddIncomingConnection(pConnection);
 	++m_amountConnections;
+	m_ChangeJournal.Record(GraphChangeType::ConnectionAdded, pConnection->GetFromNodeId(), pConnection->GetToNodeId(), pConnection->GetCost());
 
 	if (!m_isDirectional)
 	{
-		GraphConnection* oppositeConn = new GraphConnection();
-		oppositeConn->SetColor(pConnection->GetColor());
-		oppositeConn->SetCost(pConnection->GetCost());
-		oppositeConn->SetFromNodeId(pConnection->GetToNodeId());
-		oppositeConn->SetToNodeId(pConnection->GetFromNodeId());
+		GraphConnection* oppositeConn = CreateConnection(pConnection->GetToNodeId(), pConnection->GetFromNodeId(), pConnection->GetCost(), pConnection->GetColor());
 
 		m_pConnections[pConnection->GetToNodeId()].push_back(oppositeConn);
+		AddIncomingConnection(oppositeConn);
 		++m_amountConnections;
+		m_ChangeJournal.Record(GraphChangeType::ConnectionAdded, oppositeConn->GetFromNodeId(), oppositeConn->GetToNodeId(), oppositeConn->GetCost());
 	}
+
+	if (m_pSpatialIndex != nullptr)
+	{
+		m_pSpatialIndex->AddConnection(pConnection->GetFromNodeId(), pConnection->GetToNodeId());
+		if (!m_isDirectional)
+			m_pSpatialIndex->AddConnection(pConnection->GetToNodeId(), pConnection->GetFromNodeId());
+	}
+
+	NotifyGraphModified(false, true);
 }
 
 GraphConnection* const Graph::GetConnection(int from, int to) const
@@ -251,40 +279,12 @@ void Graph::RemoveConnection(int from, int to)
 {
 	assert(IsNodeValid(from) && IsNodeValid(to));
 
-	Elite::GraphConnection* conFromTo = GetConnection(from, to);
-	Elite::GraphConnection* conToFrom = GetConnection(to, from);
-
+	DestroyConnection(DetachConnection(from, to));
+	// in a directed graph the opposite connection stays in the graph
 	if (!m_isDirectional)
-	{
-		for (auto curEdge = m_pConnections[to].begin();
-			curEdge != m_pConnections[to].end();
-			++curEdge)
-		{
-			if ((*curEdge)->GetToNodeId() == from)
-			{
-				curEdge = m_pConnections[to].erase(curEdge);
-				--m_amountConnections;
-				break;
-			}
-		}
-	}
-
-	for (auto curEdge = m_pConnections[from].begin();
-		curEdge != m_pConnections[from].end();
-		++curEdge)
-	{
-		if ((*curEdge)->GetToNodeId() == to)
-		{
-			curEdge = m_pConnections[from].erase(curEdge);
-			--m_amountConnections;
-			break;
-		}
-	}
+		DestroyConnection(DetachConnection(to, from));
 
-	SAFE_DELETE(conFromTo);
-	SAFE_DELETE(conToFrom);
-
-	OnGraphModified(false, true);
+	NotifyGraphModified(false, true);
 }
 
 void Graph::RemoveConnection(GraphConnection* const pConnection)
@@ -294,23 +294,9 @@ void Graph::RemoveConnection(GraphConnection* const pConnection)
 
 void Elite::Graph::RemoveAllConnectionsWithNode(int nodeId)
 {
-	for (auto c : m_pConnections[nodeId])
-		delete c;
-	m_pConnections[nodeId].clear();
+	RemoveConnectionsWithNode(nodeId);
 
-	// remove and delete connections from other nodes to this pNode
-	auto isConnectionToThisNode = [nodeId](GraphConnection* const pCon) { return pCon->GetToNodeId() == nodeId; };
-	for (std::vector<Elite::GraphConnection*>& c : m_pConnections)
-	{
-		std::vector<GraphConnection*>::iterator foundIt{};
-		while ((foundIt = std::find_if(c.begin(), c.end(), isConnectionToThisNode)) != c.end())
-		{
-			delete* foundIt;
-			c.erase(foundIt);
-		}
-	}
-
-	OnGraphModified(false, true);
+	NotifyGraphModified(false, true);
 }
 
 const std::vector<GraphConnection*>& Graph::GetConnectionsFromNode(int nodeId) const
@@ -319,11 +305,43 @@ const std::vector<GraphConnection*>& Graph::GetConnectionsFromNode(int nodeId) c
 	return m_pConnections[nodeId];
 }
 
+const std::vector<GraphConnection*>& Graph::GetConnectionsToNode(int nodeId) const
+{
+	assert(m_TrackIncomingConnections && "<Graph::GetConnectionsToNode>: incoming connections are not tracked");
+	assert(IsNodeValid(nodeId));
+	return m_pIncomingConnections[nodeId];
+}
+
 GraphConnection* const Graph::GetConnectionAtPosition(const Vector2& position, float maxDist) const
 {
 	GraphConnection* result = nullptr;
 	float maxDistSq = maxDist * maxDist;
 
+	if (m_pSpatialIndex != nullptr)
+	{
+		std::vector<std::pair<int, int>> candidates{};
+		m_pSpatialIndex->QueryConnections(position, maxDist, candidates);
+
+		for (const std::pair<int, int>& candidate : candidates)
+		{
+			if (!IsNodeValid(candidate.first) || !IsNodeValid(candidate.second))
+				continue;
+
+			GraphConnection* const pConnection = GetConnection(candidate.first, candidate.second);
+			if (pConnection == nullptr)
+				continue;
+
+			const Elite::Vector2 projectedPoint = ProjectOnLineSegment(GetNode(candidate.second)->GetPosition(), GetNode(candidate.first)->GetPosition(), position);
+			const float currentDistSq = DistanceSquared(projectedPoint, position);
+			if (currentDistSq < maxDistSq)
+			{
+				result = pConnection;
+				maxDistSq = currentDistSq;
+			}
+		}
+		return result;
+	}
+
 	for (const std::vector<Elite::GraphConnection*>& connectionList : m_pConnections)
 	{
 		for (Elite::GraphConnection* const pConnection : connectionList)
@@ -333,7 +351,7 @@ GraphConnection* const Graph::GetConnectionAtPosition(const Vector2& position, f
 
 			const Elite::Vector2 projectedPoint = ProjectOnLineSegment(segmentStart, segmentEnd, position);
 			const float currentDistSq = DistanceSquared(projectedPoint, position);
-			if (currentDistSq < maxDist * maxDist)
+			if (currentDistSq < maxDistSq)
 			{
 				result = pConnection;
 				maxDistSq = currentDistSq;
@@ -352,38 +370,318 @@ void Graph::SetConnectionCostsToDistances()
 		{
 			Vector2 fromPos = GetNode(pConnection->GetFromNodeId())->GetPosition();
 			Vector2 toPos = GetNode(pConnection->GetToNodeId())->GetPosition();
-			pConnection->SetCost(abs(Distance(fromPos, toPos)));
+			const float cost = abs(Distance(fromPos, toPos));
+			if (cost != pConnection->GetCost())
+			{
+				pConnection->SetCost(cost);
+				m_ChangeJournal.Record(GraphChangeType::ConnectionCostChanged, pConnection->GetFromNodeId(), pConnection->GetToNodeId(), cost);
+			}
 		}
 	}
 }
 
-void Graph::UpdateNextNodeIndex()
+void Graph::SetNodePosition(int nodeId, const Vector2& position)
+{
+	GraphNode* const pNode = GetNode(nodeId);
+	if (pNode == nullptr)
+		return;
+
+	pNode->SetPosition(position);
+	if (m_pSpatialIndex != nullptr)
+		m_pSpatialIndex->MoveNode(nodeId, position);
+
+	m_ChangeJournal.Record(GraphChangeType::NodeMoved, nodeId);
+}
+
+void Graph::SetConnectionCost(int from, int to, float cost)
 {
-	int idx = 0;
-	while (true)
+	GraphConnection* const pConnection = GetConnection(from, to);
+	if (pConnection == nullptr)
+		return;
+
+	pConnection->SetCost(cost);
+	m_ChangeJournal.Record(GraphChangeType::ConnectionCostChanged, from, to, cost);
+
+	if (!m_isDirectional)
 	{
-		if (!IsNodeValid(idx))
+		GraphConnection* const pOppositeConnection = GetConnection(to, from);
+		if (pOppositeConnection != nullptr)
 		{
-			m_nextNodeId = idx;
-			return;
+			pOppositeConnection->SetCost(cost);
+			m_ChangeJournal.Record(GraphChangeType::ConnectionCostChanged, to, from, cost);
 		}
-		++idx;
 	}
 }
 
-void Graph::UpdateActiveNodes()
+void Graph::EnableSpatialIndex(float cellSize)
+{
+	m_SuspendedSpatialIndexCellSize = 0.f;
+	m_pSpatialIndex = std::make_unique<GraphSpatialIndex>(cellSize);
+
+	for (GraphNode* const pNode : m_pActiveNodes)
+		m_pSpatialIndex->AddNode(pNode->GetId(), pNode->GetPosition());
+
+	for (const std::vector<GraphConnection*>& connections : m_pConnections)
+	{
+		for (const GraphConnection* const pConnection : connections)
+			m_pSpatialIndex->AddConnection(pConnection->GetFromNodeId(), pConnection->GetToNodeId());
+	}
+}
+
+void Graph::DisableSpatialIndex()
+{
+	m_SuspendedSpatialIndexCellSize = 0.f;
+	m_pSpatialIndex.reset();
+}
+
+void Graph::BeginEdit()
+{
+	if (m_EditDepth++ > 0)
+		return;
+
+	// the spatial index is rebuilt once in EndEdit instead of following every change
+	if (m_pSpatialIndex != nullptr)
+	{
+		m_SuspendedSpatialIndexCellSize = m_pSpatialIndex->GetCellSize();
+		m_pSpatialIndex.reset();
+	}
+}
+
+void Graph::EndEdit()
+{
+	assert(m_EditDepth > 0 && "<Graph::EndEdit>: no matching BeginEdit");
+	if (--m_EditDepth > 0)
+		return;
+
+	if (m_SuspendedSpatialIndexCellSize > 0.f)
+		EnableSpatialIndex(m_SuspendedSpatialIndexCellSize);
+
+	if (m_HasPendingNodeChanges || m_HasPendingConnectionChanges)
+	{
+		const bool nrOfNodesChanged = m_HasPendingNodeChanges;
+		const bool nrOfConnectionsChanged = m_HasPendingConnectionChanges;
+		m_HasPendingNodeChanges = false;
+		m_HasPendingConnectionChanges = false;
+		OnGraphModified(nrOfNodesChanged, nrOfConnectionsChanged);
+	}
+}
+
+void Graph::ReserveNodes(int nrOfNodes)
+{
+	m_pNodes.reserve(nrOfNodes);
+	m_pConnections.reserve(nrOfNodes);
+	m_pActiveNodes.reserve(nrOfNodes);
+	m_ActiveNodeIndices.reserve(nrOfNodes);
+	if (m_TrackIncomingConnections)
+		m_pIncomingConnections.reserve(nrOfNodes);
+}
+
+void Graph::ReserveConnections(int nodeId, int nrOfConnections)
+{
+	m_pConnections[nodeId].reserve(nrOfConnections);
+	if (m_TrackIncomingConnections)
+		m_pIncomingConnections[nodeId].reserve(nrOfConnections);
+}
+
+void Graph::NotifyGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
+{
+	if (m_EditDepth == 0)
+	{
+		OnGraphModified(nrOfNodesChanged, nrOfConnectionsChanged);
+		return;
+	}
+
+	m_HasPendingNodeChanges |= nrOfNodesChanged;
+	m_HasPendingConnectionChanges |= nrOfConnectionsChanged;
+}
+
+void Graph::SetTrackIncomingConnections(bool trackIncomingConnections)
+{
+	if (m_TrackIncomingConnections == trackIncomingConnections)
+		return;
+
+	m_TrackIncomingConnections = trackIncomingConnections;
+	RebuildIncomingConnections();
+}
+
+void Graph::RebuildIncomingConnections()
+{
+	m_pIncomingConnections.clear();
+	if (!m_TrackIncomingConnections)
+		return;
+
+	m_pIncomingConnections.resize(m_pNodes.size());
+	for (const std::vector<GraphConnection*>& connections : m_pConnections)
+	{
+		for (GraphConnection* const pConnection : connections)
+			m_pIncomingConnections[pConnection->GetToNodeId()].push_back(pConnection);
+	}
+}
+
+void Graph::AddIncomingConnection(GraphConnection* const pConnection)
+{
+	if (m_TrackIncomingConnections)
+		m_pIncomingConnections[pConnection->GetToNodeId()].push_back(pConnection);
+}
+
+void Graph::RemoveIncomingConnection(const GraphConnection* const pConnection)
+{
+	if (!m_TrackIncomingConnections)
+		return;
+
+	// the order of incoming connections doesn't matter, so swap with the last one
+	std::vector<GraphConnection*>& incomingConnections = m_pIncomingConnections[pConnection->GetToNodeId()];
+	auto foundIt = std::find(incomingConnections.begin(), incomingConnections.end(), pConnection);
+	if (foundIt != incomingConnections.end())
+	{
+		*foundIt = incomingConnections.back();
+		incomingConnections.pop_back();
+	}
+}
+
+GraphConnection* Graph::DetachConnection(int from, int to)
+{
+	std::vector<GraphConnection*>& connections = m_pConnections[from];
+	auto foundIt = std::find_if(connections.begin(), connections.end(), [to](const GraphConnection* pConnection) { return pConnection->GetToNodeId() == to; });
+	if (foundIt == connections.end())
+		return nullptr;
+
+	GraphConnection* const pConnection = *foundIt;
+	connections.erase(foundIt);
+	RemoveIncomingConnection(pConnection);
+	--m_amountConnections;
+	m_ChangeJournal.Record(GraphChangeType::ConnectionRemoved, from, to, pConnection->GetCost());
+
+	if (m_pSpatialIndex != nullptr)
+		m_pSpatialIndex->RemoveConnection(from, to);
+
+	return pConnection;
+}
+
+void Graph::RemoveConnectionsWithNode(int nodeId)
+{
+	// connections leading to the node
+	if (m_TrackIncomingConnections)
+	{
+		std::vector<GraphConnection*>& incomingConnections = m_pIncomingConnections[nodeId];
+		while (!incomingConnections.empty())
+		{
+			GraphConnection* const pConnection = DetachConnection(incomingConnections.back()->GetFromNodeId(), nodeId);
+			if (pConnection == nullptr)
+				incomingConnections.pop_back();
+			DestroyConnection(pConnection);
+		}
+	}
+	else if (!m_isDirectional)
+	{
+		// every connection leading to the node mirrors one leaving it
+		for (const GraphConnection* const pConnection : m_pConnections[nodeId])
+		{
+			if (pConnection->GetToNodeId() != nodeId)
+				DestroyConnection(DetachConnection(pConnection->GetToNodeId(), nodeId));
+		}
+	}
+	else
+	{
+		// without the incoming index every connection list has to be checked
+		for (std::vector<GraphConnection*>& connections : m_pConnections)
+		{
+			auto removeIt = std::stable_partition(connections.begin(), connections.end(), [nodeId](const GraphConnection* pConnection) { return pConnection->GetToNodeId() != nodeId; });
+			for (auto connectionIt = removeIt; connectionIt != connections.end(); ++connectionIt)
+			{
+				if (m_pSpatialIndex != nullptr)
+					m_pSpatialIndex->RemoveConnection((*connectionIt)->GetFromNodeId(), nodeId);
+				--m_amountConnections;
+				m_ChangeJournal.Record(GraphChangeType::ConnectionRemoved, (*connectionIt)->GetFromNodeId(), nodeId, (*connectionIt)->GetCost());
+				DestroyConnection(*connectionIt);
+			}
+			connections.erase(removeIt, connections.end());
+		}
+	}
+
+	// connections leaving the node
+	for (GraphConnection* const pConnection : m_pConnections[nodeId])
+	{
+		if (m_pSpatialIndex != nullptr)
+			m_pSpatialIndex->RemoveConnection(nodeId, pConnection->GetToNodeId());
+		RemoveIncomingConnection(pConnection);
+		--m_amountConnections;
+		m_ChangeJournal.Record(GraphChangeType::ConnectionRemoved, nodeId, pConnection->GetToNodeId(), pConnection->GetCost());
+		DestroyConnection(pConnection);
+	}
+	m_pConnections[nodeId].clear();
+}
+
+void Graph::UpdateNextNodeIndex()
+{
+	m_nextNodeId = m_FreeNodeIds.empty() ? static_cast<int>(m_pNodes.size()) : m_FreeNodeIds.back();
+}
+
+void Graph::AddActiveNode(GraphNode* const pNode)
+{
+	const int nodeId = pNode->GetId();
+	if (m_ActiveNodeIndices.size() < m_pNodes.size())
+		m_ActiveNodeIndices.resize(m_pNodes.size(), invalid_node_id);
+
+	m_ActiveNodeIndices[nodeId] = static_cast<int>(m_pActiveNodes.size());
+	m_pActiveNodes.push_back(pNode);
+}
+
+void Graph::RemoveActiveNode(int nodeId)
+{
+	// swap with the last active node so removal doesn't shift the whole list
+	const int activeIdx = m_ActiveNodeIndices[nodeId];
+	GraphNode* const pLastNode = m_pActiveNodes.back();
+	m_pActiveNodes[activeIdx] = pLastNode;
+	m_ActiveNodeIndices[pLastNode->GetId()] = activeIdx;
+
+	m_pActiveNodes.pop_back();
+	m_ActiveNodeIndices[nodeId] = invalid_node_id;
+}
+
+void Graph::RebuildNodeBookkeeping()
 {
 	m_pActiveNodes.clear();
-	for (auto& n : m_pNodes)
+	m_FreeNodeIds.clear();
+	m_ActiveNodeIndices.assign(m_pNodes.size(), invalid_node_id);
+
+	// push free ids from high to low so the lowest free id gets reused first
+	for (int nodeId = static_cast<int>(m_pNodes.size()) - 1; nodeId >= 0; --nodeId)
 	{
-		if (n != nullptr)
+		if (m_pNodes[nodeId] == nullptr)
+			m_FreeNodeIds.push_back(nodeId);
+	}
+
+	for (GraphNode* const pNode : m_pNodes)
+	{
+		if (pNode != nullptr)
 		{
-			m_pActiveNodes.push_back(n);
+			m_ActiveNodeIndices[pNode->GetId()] = static_cast<int>(m_pActiveNodes.size());
+			m_pActiveNodes.push_back(pNode);
 		}
 	}
+
+	UpdateNextNodeIndex();
 }
 
 std::shared_ptr<Graph> Graph::Clone() const
 {
 	return std::shared_ptr<Graph>(new Graph(*this));
 }
+
+CompactGraph Graph::BuildCompactView() const
+{
+	return CompactGraph(*this);
+}
+
+std::shared_ptr<const CompactGraph> Graph::PublishSnapshot()
+{
+	std::shared_ptr<const CompactGraph> pSnapshot = m_pSnapshot.load(std::memory_order_relaxed);
+	if (IsEditing() || (pSnapshot != nullptr && pSnapshot->GetVersion() == GetVersion()))
+		return pSnapshot;
+
+	// other threads can't safely dereference our nodes, so the snapshot only keeps ids and positions
+	pSnapshot = std::make_shared<const CompactGraph>(*this, false);
+	m_pSnapshot.store(pSnapshot, std::memory_order_release);
+	return pSnapshot;
+}
\ No newline at end of file
@@ -3,19 +3,24 @@
 //*=================================================*/
 
 #pragma once
+#include <atomic>
 #include "../EliteGraphUtilities/EGraphVisuals.h"
 #include "EGraphNode.h"
 #include "EGraphEnums.h"
+#include "EGraphSpatialIndex.h"
+#include "EGraphChangeJournal.h"
 #include "../EliteGraphNodeFactory/EGraphNodeFactory.h"
+#include "../EliteGraphNodeFactory/EGraphConnectionFactory.h"
 
 namespace Elite
 {
 	class GraphConnection;
+	class CompactGraph;
 
 	class Graph
 	{
 	public:
-		Graph(bool isDirectional, GraphNodeFactory* const pNodeFactory = nullptr);
+		Graph(bool isDirectional, GraphNodeFactory* const pNodeFactory = nullptr, GraphConnectionFactory* const pConnectionFactory = nullptr);
 		Graph(const Graph& other);
 		virtual ~Graph();
 
@@ -25,8 +30,10 @@ namespace Elite
 		void Clear();
 		int GetAmountOfConnections() const { return m_amountConnections; }
 		int GetAmountOfNodes() const { return m_amountNodes; }
+		int GetNrOfNodeSlots() const { return static_cast<int>(m_pNodes.size()); }
 
 		std::shared_ptr<Graph> Clone() const;
+		CompactGraph BuildCompactView() const;
 
 		//Nodes
 		GraphNode* const GetNode(int nodeId) const;
@@ -34,6 +41,8 @@ namespace Elite
 		int AddNode(GraphNode* const pNode);
 		void RemoveNode(int nodeId);
 		const std::vector<GraphNode*>& GetAllNodes() const;
+		// Use this instead of GraphNode::SetPosition so the spatial index can follow the node
+		void SetNodePosition(int nodeId, const Vector2& position);
 
 		//Connections
 		void AddConnection(GraphConnection* const pConnection);
@@ -44,14 +53,45 @@ namespace Elite
 
 		const std::vector<GraphConnection*>& GetConnectionsFromNode(int nodeId) const;
 		const std::vector<GraphConnection*>& GetConnectionsFromNode(GraphNode* const pNode) const { return GetConnectionsFromNode(pNode->GetId()); }
+		// Only available while incoming connections are tracked
+		const std::vector<GraphConnection*>& GetConnectionsToNode(int nodeId) const;
 		GraphConnection* const GetConnectionAtPosition(const Vector2& position, float maxDist = 1.0f) const;
 
 		void SetConnectionCostsToDistances();
+		// Use this instead of GraphConnection::SetCost so the change ends up in the journal, also updates the opposite connection of undirected graphs
+		void SetConnectionCost(int fromNodeId, int toNodeId, float cost);
 
 		//Query nodes and connections
 		int GetNodeIdAtPosition(const Vector2& position, float errorMargin) const;
 		GraphNode* const GetNodeAtPosition(const Vector2& position, float errorMargin) const;
 		bool ConnectionExists(int fromNodeId, int toNodeId) const { return GetConnection(fromNodeId, toNodeId) != nullptr; }
+
+		//Optional uniform grid over nodes and connections that speeds up the position queries above
+		void EnableSpatialIndex(float cellSize);
+		void DisableSpatialIndex();
+		bool HasSpatialIndex() const { return m_pSpatialIndex != nullptr || m_SuspendedSpatialIndexCellSize > 0.f; }
+
+		//Optional index of the connections leading to every node, so removing a node or its connections only visits its neighbours
+		void SetTrackIncomingConnections(bool trackIncomingConnections);
+		bool IsTrackingIncomingConnections() const { return m_TrackIncomingConnections; }
+
+		//Edit transactions: everything changed between BeginEdit and EndEdit is reported with a single OnGraphModified
+		//and the spatial index is rebuilt once in EndEdit (position queries scan the graph in between). Transactions can be nested.
+		void BeginEdit();
+		void EndEdit();
+		bool IsEditing() const { return m_EditDepth > 0; }
+
+		//Every change increments the version, the most recent changes are kept in a bounded journal
+		unsigned long long GetVersion() const { return m_ChangeJournal.GetVersion(); }
+		bool GetChangesSince(unsigned long long version, std::vector<GraphChange>& changes) const { return m_ChangeJournal.GetChangesSince(version, changes); }
+		void SetChangeJournalCapacity(size_t capacity) { m_ChangeJournal.SetCapacity(capacity); }
+
+		//Immutable snapshots for reading the graph on other threads. Only the thread that edits the graph publishes,
+		//readers grab the last published snapshot and keep it alive for as long as they use it.
+		// Rebuilds the snapshot if the graph changed since the last one, returns the current one while editing
+		std::shared_ptr<const CompactGraph> PublishSnapshot();
+		// Safe from any thread, nullptr until the first publish
+		std::shared_ptr<const CompactGraph> GetSnapshot() const { return m_pSnapshot.load(std::memory_order_acquire); }
 		
 		virtual Vector2 GetNodePos(int nodeId) const { auto pNode = GetNode(nodeId); return pNode == nullptr ? Vector2{ 0,0 } : pNode->GetPosition(); }
 		virtual int GetNodeIdAtPosition(const Vector2& position) const { return GetNodeIdAtPosition(position, 1.0f); }
@@ -60,25 +100,58 @@ namespace Elite
 
 	protected:
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) {}
+		// Calls OnGraphModified, or remembers the changes until EndEdit while editing
+		void NotifyGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged);
+		// Capacity hints for bulk loads, so the lists don't grow one element at a time
+		void ReserveNodes(int nrOfNodes);
+		void ReserveConnections(int nodeId, int nrOfConnections);
 		void AddNodeAtIndex(GraphNode* const pNode, int index);
 
 		bool m_isDirectional;
 		int m_nextNodeId{ 0 };
 		std::vector<GraphNode*> m_pNodes;
+		// one heap allocated vector per node, these are not pooled like the nodes and connections themselves
 		std::vector<std::vector<GraphConnection*>>m_pConnections;
+		std::vector<std::vector<GraphConnection*>> m_pIncomingConnections; // not owning, only filled while incoming connections are tracked
+		bool m_TrackIncomingConnections{ false };
 		std::vector<GraphNode*> m_pActiveNodes;
+		std::vector<int> m_ActiveNodeIndices; // position of every node in m_pActiveNodes
+		std::vector<int> m_FreeNodeIds; // ids of removed nodes, reused before the graph grows
 
 		std::shared_ptr<GraphNodeFactory> m_pNodeFactory;
+		std::shared_ptr<GraphConnectionFactory> m_pConnectionFactory;
+		std::unique_ptr<GraphSpatialIndex> m_pSpatialIndex;
+		GraphChangeJournal m_ChangeJournal{};
+		std::atomic<std::shared_ptr<const CompactGraph>> m_pSnapshot{};
 
 		GraphNode* CreateNode(const Vector2& pos) { return m_pNodeFactory == nullptr ? new GraphNode(pos) : m_pNodeFactory->CreateNode(pos); }
 		GraphNode* CloneNode(const GraphNode& other) { return m_pNodeFactory == nullptr ? new GraphNode(other) : m_pNodeFactory->CloneNode(other); }
+		void DestroyNode(GraphNode* pNode) { if (m_pNodeFactory == nullptr) delete pNode; else m_pNodeFactory->DestroyNode(pNode); }
+
+		GraphConnection* CreateConnection(int fromId, int toId, float cost = 1.f, const Color& color = DEFAULT_CONNECTION_COLOR) { return m_pConnectionFactory->CreateConnection(fromId, toId, cost, color); }
+		GraphConnection* CloneConnection(const GraphConnection& other) { return m_pConnectionFactory->CloneConnection(other); }
+		void DestroyConnection(GraphConnection* pConnection) { m_pConnectionFactory->DestroyConnection(pConnection); }
 	
 	private:
 		int m_amountNodes{ 0 };
 		int m_amountConnections{ 0 };
 
+		int m_EditDepth{ 0 };
+		bool m_HasPendingNodeChanges{ false };
+		bool m_HasPendingConnectionChanges{ false };
+		float m_SuspendedSpatialIndexCellSize{ 0.f }; // cell size of the spatial index while it is switched off during an edit
+
 		void UpdateNextNodeIndex();
-		void UpdateActiveNodes();
+		void AddActiveNode(GraphNode* const pNode);
+		void RemoveActiveNode(int nodeId);
+		void RebuildNodeBookkeeping();
+
+		void RebuildIncomingConnections();
+		void AddIncomingConnection(GraphConnection* const pConnection);
+		void RemoveIncomingConnection(const GraphConnection* const pConnection);
+		// Takes the connection out of all lists without destroying it, returns nullptr if there is none
+		GraphConnection* DetachConnection(int from, int to);
+		void RemoveConnectionsWithNode(int nodeId);
 	};
 
 
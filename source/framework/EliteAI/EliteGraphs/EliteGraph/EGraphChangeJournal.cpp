@@ -0,0 +1,66 @@
+#include "stdafx.h"
+#include "EGraphChangeJournal.h"
+
+using namespace Elite;
+
+GraphChangeJournal::GraphChangeJournal(size_t capacity, unsigned long long startVersion)
+	: m_Capacity{ capacity }
+	, m_Version{ startVersion }
+	, m_FirstKnownVersion{ startVersion }
+{
+}
+
+void GraphChangeJournal::SetCapacity(size_t capacity)
+{
+	m_Capacity = capacity;
+	m_Changes.clear();
+	m_Changes.shrink_to_fit();
+	m_OldestIdx = 0;
+	m_FirstKnownVersion = m_Version;
+}
+
+void GraphChangeJournal::Record(GraphChangeType type, int fromNodeId, int toNodeId, float cost)
+{
+	++m_Version;
+	if (m_Capacity == 0)
+	{
+		m_FirstKnownVersion = m_Version;
+		return;
+	}
+
+	const GraphChange change{ type, fromNodeId, toNodeId, cost, m_Version };
+	if (m_Changes.size() < m_Capacity)
+	{
+		m_Changes.push_back(change);
+		return;
+	}
+
+	// full, overwrite the oldest change
+	m_FirstKnownVersion = m_Changes[m_OldestIdx].version;
+	m_Changes[m_OldestIdx] = change;
+	m_OldestIdx = (m_OldestIdx + 1) % m_Capacity;
+}
+
+void GraphChangeJournal::Reset()
+{
+	++m_Version;
+	m_Changes.clear();
+	m_OldestIdx = 0;
+	m_FirstKnownVersion = m_Version;
+}
+
+bool GraphChangeJournal::GetChangesSince(unsigned long long version, std::vector<GraphChange>& changes) const
+{
+	if (version < m_FirstKnownVersion)
+		return false;
+	if (version >= m_Version)
+		return true;
+
+	// every change increments the version by one, so the last (m_Version - version) entries are the ones we need
+	const size_t nrOfChanges = static_cast<size_t>(m_Version - version);
+	const size_t firstIdx = m_OldestIdx + m_Changes.size() - nrOfChanges;
+	for (size_t i = 0; i < nrOfChanges; ++i)
+		changes.push_back(m_Changes[(firstIdx + i) % m_Changes.size()]);
+
+	return true;
+}
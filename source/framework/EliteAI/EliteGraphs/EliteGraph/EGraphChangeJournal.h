@@ -0,0 +1,58 @@
+//*=================================================*/
+// EGraphChangeJournal.h: Version counter and bounded history of the changes made to a graph,
+// so path caches, renderers and planners can update only what changed since the version they last saw
+//*=================================================*/
+
+#pragma once
+#include "EGraphEnums.h"
+
+namespace Elite
+{
+	enum class GraphChangeType
+	{
+		NodeAdded,
+		NodeRemoved,
+		NodeMoved,
+		ConnectionAdded,
+		ConnectionRemoved,
+		ConnectionCostChanged
+	};
+
+	struct GraphChange final
+	{
+		GraphChangeType type;
+		int fromNodeId; // the node itself for node changes
+		int toNodeId; // invalid_node_id for node changes
+		float cost; // new cost for added or changed connections, old cost for removed ones
+		unsigned long long version; // graph version right after this change
+	};
+
+	class GraphChangeJournal final
+	{
+	public:
+		static const size_t DEFAULT_CAPACITY = 4096;
+
+		explicit GraphChangeJournal(size_t capacity = DEFAULT_CAPACITY, unsigned long long startVersion = 0);
+
+		unsigned long long GetVersion() const { return m_Version; }
+		size_t GetCapacity() const { return m_Capacity; }
+		// Changing the capacity forgets the recorded changes
+		void SetCapacity(size_t capacity);
+
+		void Record(GraphChangeType type, int fromNodeId, int toNodeId = invalid_node_id, float cost = 0.f);
+		// Counts as a change but forgets all recorded changes, for changes that are too big to describe (e.g. clearing the graph)
+		void Reset();
+
+		// Appends the changes made after the given version in the order they happened.
+		// Returns false if some of them are no longer in the journal, the caller then has to start over.
+		bool GetChangesSince(unsigned long long version, std::vector<GraphChange>& changes) const;
+
+	private:
+		std::vector<GraphChange> m_Changes{}; // ring buffer once it reaches the capacity
+		size_t m_Capacity;
+		size_t m_OldestIdx{ 0 };
+
+		unsigned long long m_Version;
+		unsigned long long m_FirstKnownVersion; // every change after this version is still in the journal
+	};
+}
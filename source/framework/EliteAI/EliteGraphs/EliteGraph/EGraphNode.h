@@ -24,6 +24,7 @@ namespace Elite
 		Elite::Color m_Color;
 
 		friend class Graph;
+		friend class GraphOverlay;
 		void SetId(int id) { m_Id = id; }
 	};
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "stdafx.h"
+#include "EGraphOverlay.h"
+#include "EGraph.h"
+#include "EGraphConnection.h"
+
+using namespace Elite;
+
+// returned for nodes that have no connections of that kind
+static const std::vector<GraphConnection*> NO_CONNECTIONS{};
+
+GraphOverlay::GraphOverlay(const Graph* const pBaseGraph)
+	: m_pBaseGraph{ pBaseGraph }
+	, m_FirstOverlayNodeId{ pBaseGraph->GetNrOfNodeSlots() }
+{
+}
+
+GraphOverlay::~GraphOverlay()
+{
+	Clear();
+}
+
+bool GraphOverlay::IsDirectional() const
+{
+	return m_pBaseGraph->IsDirectional();
+}
+
+void GraphOverlay::Clear()
+{
+	for (GraphNode* pNode : m_pNodes)
+		SAFE_DELETE(pNode);
+	m_pNodes.clear();
+
+	for (auto& connectionList : m_pConnections)
+	{
+		for (GraphConnection* pConnection : connectionList.second)
+			SAFE_DELETE(pConnection);
+	}
+	m_pConnections.clear();
+
+	m_FirstOverlayNodeId = m_pBaseGraph->GetNrOfNodeSlots();
+}
+
+int GraphOverlay::AddNode(GraphNode* const pNode)
+{
+	const int nodeId = GetNrOfNodeSlots();
+	pNode->SetId(nodeId);
+	m_pNodes.push_back(pNode);
+	return nodeId;
+}
+
+GraphNode* const GraphOverlay::GetNode(int nodeId) const
+{
+	if (IsOverlayNode(nodeId))
+		return m_pNodes[nodeId - m_FirstOverlayNodeId];
+
+	return m_pBaseGraph->GetNode(nodeId);
+}
+
+bool GraphOverlay::IsNodeValid(int nodeId) const
+{
+	return IsOverlayNode(nodeId) || m_pBaseGraph->IsNodeValid(nodeId);
+}
+
+Vector2 GraphOverlay::GetNodePos(int nodeId) const
+{
+	if (IsOverlayNode(nodeId))
+		return m_pNodes[nodeId - m_FirstOverlayNodeId]->GetPosition();
+
+	return m_pBaseGraph->GetNodePos(nodeId);
+}
+
+void GraphOverlay::AddConnection(int fromNodeId, int toNodeId, float cost)
+{
+	assert(IsNodeValid(fromNodeId) && IsNodeValid(toNodeId) && "<GraphOverlay::AddConnection>: invalid node index");
+
+	m_pConnections[fromNodeId].push_back(new GraphConnection(fromNodeId, toNodeId, cost));
+	if (!IsDirectional())
+		m_pConnections[toNodeId].push_back(new GraphConnection(toNodeId, fromNodeId, cost));
+}
+
+const std::vector<GraphConnection*>& GraphOverlay::GetBaseConnectionsFromNode(int nodeId) const
+{
+	if (IsOverlayNode(nodeId))
+		return NO_CONNECTIONS;
+
+	return m_pBaseGraph->GetConnectionsFromNode(nodeId);
+}
+
+const std::vector<GraphConnection*>& GraphOverlay::GetOverlayConnectionsFromNode(int nodeId) const
+{
+	auto connectionsIt = m_pConnections.find(nodeId);
+	if (connectionsIt == m_pConnections.end())
+		return NO_CONNECTIONS;
+
+	return connectionsIt->second;
+}
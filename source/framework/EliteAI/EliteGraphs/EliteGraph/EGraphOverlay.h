@@ -0,0 +1,49 @@
+//*=================================================*/
+// EGraphOverlay.h: Temporary nodes and connections layered on top of a graph,
+// so a search can use extra nodes (e.g. start/end positions) without copying or modifying the graph
+//*=================================================*/
+
+#pragma once
+#include <unordered_map>
+
+namespace Elite
+{
+	class Graph;
+	class GraphNode;
+	class GraphConnection;
+
+	class GraphOverlay final
+	{
+	public:
+		explicit GraphOverlay(const Graph* const pBaseGraph);
+		~GraphOverlay();
+
+		const Graph* GetBaseGraph() const { return m_pBaseGraph; }
+		bool IsDirectional() const;
+		// Overlay nodes get the ids right after the last node slot of the base graph
+		int GetNrOfNodeSlots() const { return m_FirstOverlayNodeId + static_cast<int>(m_pNodes.size()); }
+		bool IsOverlayNode(int nodeId) const { return nodeId >= m_FirstOverlayNodeId && nodeId < GetNrOfNodeSlots(); }
+		void Clear();
+
+		//Nodes (the overlay takes ownership)
+		int AddNode(GraphNode* const pNode);
+		GraphNode* const GetNode(int nodeId) const;
+		bool IsNodeValid(int nodeId) const;
+		Vector2 GetNodePos(int nodeId) const;
+
+		//Connections, mirrored when the base graph is not directional
+		void AddConnection(int fromNodeId, int toNodeId, float cost);
+		const std::vector<GraphConnection*>& GetBaseConnectionsFromNode(int nodeId) const;
+		const std::vector<GraphConnection*>& GetOverlayConnectionsFromNode(int nodeId) const;
+
+	private:
+		const Graph* m_pBaseGraph;
+		int m_FirstOverlayNodeId;
+
+		std::vector<GraphNode*> m_pNodes{};
+		std::unordered_map<int, std::vector<GraphConnection*>> m_pConnections{};
+
+		GraphOverlay(const GraphOverlay& other) = delete;
+		GraphOverlay& operator=(const GraphOverlay& other) = delete;
+	};
+}
@@ -0,0 +1,239 @@
+#include "stdafx.h"
+#include "EGraphSpatialIndex.h"
+
+using namespace Elite;
+
+GraphSpatialIndex::GraphSpatialIndex(float cellSize)
+	: m_CellSize{ cellSize > 0.f ? cellSize : 1.f }
+{
+}
+
+void GraphSpatialIndex::Clear()
+{
+	m_NodeCells.clear();
+	m_NodePositions.clear();
+	m_NodeConnections.clear();
+	m_ConnectionLevels.clear();
+	m_Connections.clear();
+}
+
+//== NODES ==
+void GraphSpatialIndex::AddNode(int nodeId, const Vector2& pos)
+{
+	m_NodePositions[nodeId] = pos;
+	m_NodeCells[GetCellKey(GetCellCoordinate(pos.x), GetCellCoordinate(pos.y))].push_back(nodeId);
+}
+
+void GraphSpatialIndex::RemoveNode(int nodeId)
+{
+	auto posIt = m_NodePositions.find(nodeId);
+	if (posIt == m_NodePositions.end())
+		return;
+
+	// connections normally get removed by the graph first, this catches any leftovers
+	auto connectionsIt = m_NodeConnections.find(nodeId);
+	if (connectionsIt != m_NodeConnections.end())
+	{
+		const std::vector<ConnectionKey> connectionKeys = connectionsIt->second;
+		for (ConnectionKey key : connectionKeys)
+		{
+			if (EraseConnection(key) == 0)
+				continue;
+
+			EraseUnordered(m_NodeConnections[static_cast<int>(key >> 32)], key);
+			EraseUnordered(m_NodeConnections[static_cast<int>(key & 0xFFFFFFFF)], key);
+		}
+		m_NodeConnections.erase(nodeId);
+	}
+
+	const Vector2& pos = posIt->second;
+	EraseUnordered(m_NodeCells[GetCellKey(GetCellCoordinate(pos.x), GetCellCoordinate(pos.y))], nodeId);
+	m_NodePositions.erase(posIt);
+}
+
+void GraphSpatialIndex::MoveNode(int nodeId, const Vector2& newPos)
+{
+	auto posIt = m_NodePositions.find(nodeId);
+	if (posIt == m_NodePositions.end())
+		return;
+
+	const Vector2 oldPos = posIt->second;
+	posIt->second = newPos;
+
+	const CellKey oldCell = GetCellKey(GetCellCoordinate(oldPos.x), GetCellCoordinate(oldPos.y));
+	const CellKey newCell = GetCellKey(GetCellCoordinate(newPos.x), GetCellCoordinate(newPos.y));
+	if (oldCell != newCell)
+	{
+		EraseUnordered(m_NodeCells[oldCell], nodeId);
+		m_NodeCells[newCell].push_back(nodeId);
+	}
+
+	// every connection touching the node now covers a different segment
+	auto connectionsIt = m_NodeConnections.find(nodeId);
+	if (connectionsIt == m_NodeConnections.end())
+		return;
+
+	for (ConnectionKey key : connectionsIt->second)
+	{
+		// a loop is listed twice for its node, it is only moved the first time
+		const int count = EraseConnection(key);
+		if (count > 0)
+			InsertConnection(key, count);
+	}
+}
+
+//== CONNECTIONS ==
+void GraphSpatialIndex::AddConnection(int fromNodeId, int toNodeId)
+{
+	const ConnectionKey key = GetConnectionKey(fromNodeId, toNodeId);
+	auto connectionIt = m_Connections.find(key);
+	if (connectionIt != m_Connections.end())
+	{
+		++connectionIt->second.count;
+		return;
+	}
+
+	if (m_NodePositions.find(fromNodeId) == m_NodePositions.end() || m_NodePositions.find(toNodeId) == m_NodePositions.end())
+		return;
+
+	InsertConnection(key, 1);
+	m_NodeConnections[fromNodeId].push_back(key);
+	m_NodeConnections[toNodeId].push_back(key);
+}
+
+void GraphSpatialIndex::RemoveConnection(int fromNodeId, int toNodeId)
+{
+	const ConnectionKey key = GetConnectionKey(fromNodeId, toNodeId);
+	auto connectionIt = m_Connections.find(key);
+	if (connectionIt == m_Connections.end())
+		return;
+
+	if (--connectionIt->second.count > 0)
+		return;
+
+	EraseConnection(key);
+	EraseUnordered(m_NodeConnections[fromNodeId], key);
+	EraseUnordered(m_NodeConnections[toNodeId], key);
+}
+
+void GraphSpatialIndex::InsertConnection(ConnectionKey key, int count)
+{
+	const Vector2& fromPos = m_NodePositions.at(static_cast<int>(key >> 32));
+	const Vector2& toPos = m_NodePositions.at(static_cast<int>(key & 0xFFFFFFFF));
+
+	// the segment crosses about as many cells as its bounding box is wide plus high
+	int level = 0;
+	CellRange range = GetCellRange(fromPos, toPos, level);
+	while (abs(range.maxX - range.minX) + abs(range.maxY - range.minY) + 1 > MAX_CELLS_PER_CONNECTION)
+		range = GetCellRange(fromPos, toPos, ++level);
+
+	if (static_cast<int>(m_ConnectionLevels.size()) <= level)
+		m_ConnectionLevels.resize(level + 1);
+
+	IndexedConnection& connection = m_Connections[key];
+	connection.level = level;
+	connection.count = count;
+	connection.cells.clear();
+	GetSegmentCells(fromPos, toPos, level, connection.cells);
+	for (CellKey cell : connection.cells)
+		m_ConnectionLevels[level][cell].push_back(key);
+}
+
+int GraphSpatialIndex::EraseConnection(ConnectionKey key)
+{
+	auto connectionIt = m_Connections.find(key);
+	if (connectionIt == m_Connections.end())
+		return 0;
+
+	const int count = connectionIt->second.count;
+	std::unordered_map<CellKey, std::vector<ConnectionKey>>& cells = m_ConnectionLevels[connectionIt->second.level];
+	for (CellKey cell : connectionIt->second.cells)
+	{
+		auto cellIt = cells.find(cell);
+		EraseUnordered(cellIt->second, key);
+		if (cellIt->second.empty())
+			cells.erase(cellIt);
+	}
+
+	m_Connections.erase(connectionIt);
+	return count;
+}
+
+//== QUERIES ==
+void GraphSpatialIndex::QueryNodes(const Vector2& pos, float radius, std::vector<int>& nodeIds) const
+{
+	const CellRange range = GetCellRange(pos - Vector2{ radius, radius }, pos + Vector2{ radius, radius });
+	for (int y = range.minY; y <= range.maxY; ++y)
+	{
+		for (int x = range.minX; x <= range.maxX; ++x)
+		{
+			auto cellIt = m_NodeCells.find(GetCellKey(x, y));
+			if (cellIt != m_NodeCells.end())
+				nodeIds.insert(nodeIds.end(), cellIt->second.begin(), cellIt->second.end());
+		}
+	}
+}
+
+void GraphSpatialIndex::QueryConnections(const Vector2& pos, float radius, std::vector<std::pair<int, int>>& connections) const
+{
+	// a connection covering several of the queried cells shows up more than once, callers don't mind
+	const Vector2 min = pos - Vector2{ radius, radius };
+	const Vector2 max = pos + Vector2{ radius, radius };
+	for (int level = 0; level < static_cast<int>(m_ConnectionLevels.size()); ++level)
+	{
+		const std::unordered_map<CellKey, std::vector<ConnectionKey>>& cells = m_ConnectionLevels[level];
+		if (cells.empty())
+			continue;
+
+		const CellRange range = GetCellRange(min, max, level);
+		for (int y = range.minY; y <= range.maxY; ++y)
+		{
+			for (int x = range.minX; x <= range.maxX; ++x)
+			{
+				auto cellIt = cells.find(GetCellKey(x, y));
+				if (cellIt == cells.end())
+					continue;
+
+				for (ConnectionKey key : cellIt->second)
+					connections.emplace_back(static_cast<int>(key >> 32), static_cast<int>(key & 0xFFFFFFFF));
+			}
+		}
+	}
+}
+
+GraphSpatialIndex::CellRange GraphSpatialIndex::GetCellRange(const Vector2& min, const Vector2& max, int level) const
+{
+	const float cellSize = GetLevelCellSize(level);
+	auto getCellCoordinate = [cellSize](float value) { return static_cast<int>(floorf(value / cellSize)); };
+	return CellRange{ getCellCoordinate(min.x), getCellCoordinate(min.y), getCellCoordinate(max.x), getCellCoordinate(max.y) };
+}
+
+// Goes through the columns of cells between both ends, in every column the segment covers the rows between
+// its heights at the left and right edge of the column (clamped to the segment)
+void GraphSpatialIndex::GetSegmentCells(const Vector2& from, const Vector2& to, int level, std::vector<CellKey>& cells) const
+{
+	const float cellSize = GetLevelCellSize(level);
+	const Vector2& left = from.x <= to.x ? from : to;
+	const Vector2& right = from.x <= to.x ? to : from;
+	const CellRange range = GetCellRange(left, right, level);
+
+	for (int x = range.minX; x <= range.maxX; ++x)
+	{
+		float minY = left.y;
+		float maxY = right.y;
+		if (right.x > left.x)
+		{
+			const float slope = (right.y - left.y) / (right.x - left.x);
+			const float columnLeft = std::max(left.x, x * cellSize);
+			const float columnRight = std::min(right.x, (x + 1) * cellSize);
+			minY = left.y + slope * (columnLeft - left.x);
+			maxY = left.y + slope * (columnRight - left.x);
+		}
+		if (minY > maxY)
+			std::swap(minY, maxY);
+
+		const int maxCellY = static_cast<int>(floorf(maxY / cellSize));
+		for (int y = static_cast<int>(floorf(minY / cellSize)); y <= maxCellY; ++y)
+			cells.push_back(GetCellKey(x, y));
+	}
+}
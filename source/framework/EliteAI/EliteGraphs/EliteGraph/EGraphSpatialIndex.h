@@ -0,0 +1,84 @@
+//*=================================================*/
+// EGraphSpatialIndex.h: Uniform grid over the node positions of a graph and grids with ever bigger cells over its
+// connection segments, used to answer picking queries without visiting every node/connection
+//*=================================================*/
+
+#pragma once
+#include <unordered_map>
+
+namespace Elite
+{
+	class GraphSpatialIndex final
+	{
+	public:
+		explicit GraphSpatialIndex(float cellSize);
+
+		float GetCellSize() const { return m_CellSize; }
+		void Clear();
+
+		//Nodes
+		void AddNode(int nodeId, const Vector2& pos);
+		void RemoveNode(int nodeId);
+		void MoveNode(int nodeId, const Vector2& newPos);
+
+		//Connections (the positions of both nodes have to be known to the index).
+		//Parallel connections between the same nodes are counted, the entry stays until the last one is removed
+		void AddConnection(int fromNodeId, int toNodeId);
+		void RemoveConnection(int fromNodeId, int toNodeId);
+
+		//Queries, these return candidates that are possibly in range, callers do the exact test
+		void QueryNodes(const Vector2& pos, float radius, std::vector<int>& nodeIds) const;
+		void QueryConnections(const Vector2& pos, float radius, std::vector<std::pair<int, int>>& connections) const;
+
+	private:
+		using CellKey = long long;
+		using ConnectionKey = unsigned long long;
+
+		struct CellRange
+		{
+			int minX, minY, maxX, maxY;
+		};
+
+		struct IndexedConnection
+		{
+			int level;
+			std::vector<CellKey> cells; // the cells of its level the segment crosses
+			int count; // parallel connections between the same nodes
+		};
+
+		// Connections are stored in the cells their segment crosses, on the finest level where that is at most this many cells.
+		// Every next level has cells that are LEVEL_SCALE times as wide, so long connections end up in a few big cells
+		static const int MAX_CELLS_PER_CONNECTION = 16;
+		static const int LEVEL_SCALE = 8;
+
+		float m_CellSize;
+
+		std::unordered_map<CellKey, std::vector<int>> m_NodeCells{};
+		std::unordered_map<int, Vector2> m_NodePositions{};
+		std::unordered_map<int, std::vector<ConnectionKey>> m_NodeConnections{};
+
+		std::vector<std::unordered_map<CellKey, std::vector<ConnectionKey>>> m_ConnectionLevels{};
+		std::unordered_map<ConnectionKey, IndexedConnection> m_Connections{};
+
+		int GetCellCoordinate(float value) const { return static_cast<int>(floorf(value / m_CellSize)); }
+		float GetLevelCellSize(int level) const { return m_CellSize * powf(static_cast<float>(LEVEL_SCALE), static_cast<float>(level)); }
+		CellRange GetCellRange(const Vector2& min, const Vector2& max, int level = 0) const;
+		void GetSegmentCells(const Vector2& from, const Vector2& to, int level, std::vector<CellKey>& cells) const;
+		static CellKey GetCellKey(int x, int y) { return (static_cast<CellKey>(x) << 32) ^ static_cast<unsigned int>(y); }
+		static ConnectionKey GetConnectionKey(int fromNodeId, int toNodeId) { return (static_cast<ConnectionKey>(static_cast<unsigned int>(fromNodeId)) << 32) | static_cast<unsigned int>(toNodeId); }
+
+		void InsertConnection(ConnectionKey key, int count);
+		// Takes the connection out of the cells, returns how many parallel connections it stood for
+		int EraseConnection(ConnectionKey key);
+
+		template<typename T>
+		static void EraseUnordered(std::vector<T>& items, const T& item)
+		{
+			auto foundIt = std::find(items.begin(), items.end(), item);
+			if (foundIt == items.end())
+				return;
+			*foundIt = items.back();
+			items.pop_back();
+		}
+	};
+}
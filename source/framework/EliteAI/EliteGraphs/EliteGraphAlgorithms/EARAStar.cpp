@@ -0,0 +1,281 @@
+#include "stdafx.h"
+#include "EARAStar.h"
+#include <chrono>
+
+using namespace Elite;
+
+ARAStar::ARAStar(Graph* const pGraph, Heuristic hFunction)
+	: m_pGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+}
+
+ARAStar::ARAStar(const CompactGraph* const pGraph, Heuristic hFunction)
+	: m_pCompactGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+}
+
+ARAStar::ARAStar(const GraphOverlay* const pGraph, Heuristic hFunction)
+	: m_pOverlay(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+}
+
+void ARAStar::SetWeights(float initialWeight, float weightStep)
+{
+	assert(initialWeight >= 1.f && weightStep > 0.f && "ARAStar: the weight has to start at 1 or more and go down");
+	m_InitialWeight = initialWeight;
+	m_WeightStep = weightStep;
+}
+
+void ARAStar::BeginSearch(int startNodeId, int goalNodeId)
+{
+	m_StartNodeId = startNodeId;
+	m_GoalNodeId = goalNodeId;
+	m_GoalPos = GetNodePos(goalNodeId);
+	m_Version = GetVersion();
+	m_Weight = m_InitialWeight;
+	m_IsFinished = false;
+	m_NrOfExpandedNodes = 0;
+
+	m_PathIds.clear();
+	m_PathCost = FLT_MAX;
+	m_SuboptimalityBound = FLT_MAX;
+
+	const int nrOfNodeSlots = GetNrOfNodeSlots();
+	m_Context.BeginSearch(nrOfNodeSlots);
+	if (static_cast<int>(m_ClosedIterations.size()) < nrOfNodeSlots)
+	{
+		m_ClosedIterations.resize(nrOfNodeSlots, 0);
+		m_InconsistentIterations.resize(nrOfNodeSlots, 0);
+	}
+
+	// a new iteration leaves the nodes of the previous query open
+	BeginIteration();
+	m_InconsistentNodeIds.clear();
+
+	m_Context.SetReached(startNodeId, 0.f, invalid_node_id);
+	m_Context.GetOpenList().Push(startNodeId, GetKey(startNodeId));
+}
+
+bool ARAStar::Improve(float maxMicroseconds)
+{
+	assert(m_GoalNodeId != invalid_node_id && "ARAStar: BeginSearch has to be called first");
+	if (m_IsFinished)
+		return true;
+
+	if (GetVersion() != m_Version)
+		BeginSearch(m_StartNodeId, m_GoalNodeId);
+
+	const auto startTime = std::chrono::steady_clock::now();
+	IndexedPriorityQueue& openNodes = m_Context.GetOpenList();
+	int nrOfExpansions = 0;
+	while (true)
+	{
+		// the path for this weight is found when no open node has a lower key than the goal
+		if (openNodes.IsEmpty() || m_Context.GetCostSoFar(m_GoalNodeId) <= openNodes.GetTopPriority())
+		{
+			FinishIteration();
+			if (m_IsFinished)
+				return true;
+		}
+		else
+		{
+			ExpandNode(openNodes.Pop());
+		}
+
+		if (maxMicroseconds != FLT_MAX && ++nrOfExpansions % 64 == 0)
+		{
+			const std::chrono::duration<float, std::micro> elapsedTime = std::chrono::steady_clock::now() - startTime;
+			if (elapsedTime.count() >= maxMicroseconds)
+				return false;
+		}
+	}
+}
+
+void ARAStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, float maxMicroseconds, std::vector<GraphNode*>& path)
+{
+	Search(pStartNode->GetId(), pGoalNode->GetId(), maxMicroseconds);
+	GetPath(path);
+}
+
+void ARAStar::FindPathIds(int startNodeId, int goalNodeId, float maxMicroseconds, std::vector<int>& path)
+{
+	Search(startNodeId, goalNodeId, maxMicroseconds);
+	path = m_PathIds;
+}
+
+void ARAStar::GetPath(std::vector<GraphNode*>& path) const
+{
+	path.clear();
+	for (int nodeId : m_PathIds)
+		path.push_back(GetNode(nodeId));
+}
+
+void ARAStar::Search(int startNodeId, int goalNodeId, float maxMicroseconds)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	BeginSearch(startNodeId, goalNodeId);
+
+	bool isFinished = Improve(maxMicroseconds);
+	while (!isFinished)
+	{
+		const std::chrono::duration<float, std::micro> elapsedTime = std::chrono::steady_clock::now() - startTime;
+		if (HasPath() && elapsedTime.count() >= maxMicroseconds)
+			break;
+
+		// without a path the search goes on in small steps until it has one
+		isFinished = Improve(std::max(maxMicroseconds - elapsedTime.count(), 0.f));
+	}
+}
+
+void ARAStar::ExpandNode(int nodeId)
+{
+	++m_NrOfExpandedNodes;
+	m_ClosedIterations[nodeId] = m_Iteration;
+
+	IndexedPriorityQueue& openNodes = m_Context.GetOpenList();
+	const float currentCostSoFar = m_Context.GetCostSoFar(nodeId);
+	VisitConnections(nodeId, [&](int toNodeId, float connectionCost)
+		{
+			const float gCost = currentCostSoFar + connectionCost;
+			if (gCost >= m_Context.GetCostSoFar(toNodeId))
+				return;
+
+			m_Context.SetReached(toNodeId, gCost, nodeId);
+			// a node is expanded at most once per weight, one that improves after that waits for the next weight
+			if (m_ClosedIterations[toNodeId] != m_Iteration)
+			{
+				openNodes.Push(toNodeId, GetKey(toNodeId));
+			}
+			else if (m_InconsistentIterations[toNodeId] != m_Iteration)
+			{
+				m_InconsistentIterations[toNodeId] = m_Iteration;
+				m_InconsistentNodeIds.push_back(toNodeId);
+			}
+		});
+}
+
+// Publishes the path of the weight that just finished and lowers the weight for the next one
+void ARAStar::FinishIteration()
+{
+	IndexedPriorityQueue& openNodes = m_Context.GetOpenList();
+	const float goalCost = m_Context.GetCostSoFar(m_GoalNodeId);
+	if (goalCost == FLT_MAX)
+	{
+		// every reachable node was expanded
+		m_IsFinished = true;
+		return;
+	}
+
+	// nodes on the path can have improved after the goal was reached, so the path can cost less than the goal
+	m_PathIds.clear();
+	m_PathCost = 0.f;
+	for (int nodeId = m_GoalNodeId; nodeId != invalid_node_id; nodeId = m_Context.GetParent(nodeId))
+	{
+		const int parentNodeId = m_Context.GetParent(nodeId);
+		if (parentNodeId != invalid_node_id)
+			m_PathCost += GetConnectionCost(parentNodeId, nodeId);
+		m_PathIds.push_back(nodeId);
+	}
+	std::reverse(m_PathIds.begin(), m_PathIds.end());
+
+	// a cheaper path has to go through an open or inconsistent node, so it can't cost less than their lowest unweighted estimate
+	float lowestCost = goalCost;
+	for (int heapIdx = 0; heapIdx < openNodes.GetSize(); ++heapIdx)
+	{
+		const int nodeId = openNodes.GetIdAt(heapIdx);
+		lowestCost = std::min(lowestCost, m_Context.GetCostSoFar(nodeId) + GetHeuristicCost(nodeId));
+	}
+	for (int nodeId : m_InconsistentNodeIds)
+		lowestCost = std::min(lowestCost, m_Context.GetCostSoFar(nodeId) + GetHeuristicCost(nodeId));
+	m_SuboptimalityBound = lowestCost > 0.f ? std::min(m_Weight, goalCost / lowestCost) : 1.f;
+
+	if (m_SuboptimalityBound <= 1.f)
+	{
+		m_SuboptimalityBound = 1.f;
+		m_IsFinished = true;
+		return;
+	}
+
+	// the inconsistent nodes are opened again and every open node gets the key of the lower weight
+	m_Weight = std::max(m_Weight - m_WeightStep, 1.f);
+	BeginIteration();
+
+	m_ReopenNodeIds.swap(m_InconsistentNodeIds);
+	m_InconsistentNodeIds.clear();
+	for (int heapIdx = 0; heapIdx < openNodes.GetSize(); ++heapIdx)
+		m_ReopenNodeIds.push_back(openNodes.GetIdAt(heapIdx));
+	for (int nodeId : m_ReopenNodeIds)
+		openNodes.Push(nodeId, GetKey(nodeId));
+	m_ReopenNodeIds.clear();
+}
+
+// Stamps of older iterations count as open and consistent
+void ARAStar::BeginIteration()
+{
+	// after a wrap around, old stamps could have the new iteration so they have to be cleared once
+	if (++m_Iteration == 0)
+	{
+		std::fill(m_ClosedIterations.begin(), m_ClosedIterations.end(), 0);
+		std::fill(m_InconsistentIterations.begin(), m_InconsistentIterations.end(), 0);
+		m_Iteration = 1;
+	}
+}
+
+template<typename Visitor>
+void ARAStar::VisitConnections(int nodeId, const Visitor& visit) const
+{
+	if (m_pCompactGraph != nullptr)
+		CompactGraphView{ m_pCompactGraph }.ForEachConnection(nodeId, visit);
+	else if (m_pOverlay != nullptr)
+		GraphOverlayView{ m_pOverlay }.ForEachConnection(nodeId, visit);
+	else
+		GraphView{ m_pGraph }.ForEachConnection(nodeId, visit);
+}
+
+float ARAStar::GetConnectionCost(int fromNodeId, int toNodeId) const
+{
+	float cost = FLT_MAX;
+	VisitConnections(fromNodeId, [&](int connectionToNodeId, float connectionCost)
+		{
+			if (connectionToNodeId == toNodeId)
+				cost = std::min(cost, connectionCost);
+		});
+	return cost;
+}
+
+float ARAStar::GetHeuristicCost(int nodeId) const
+{
+	const Vector2 toDestination = m_GoalPos - GetNodePos(nodeId);
+	return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+}
+
+int ARAStar::GetNrOfNodeSlots() const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNrOfNodeSlots();
+	return m_pOverlay != nullptr ? m_pOverlay->GetNrOfNodeSlots() : m_pGraph->GetNrOfNodeSlots();
+}
+
+GraphNode* ARAStar::GetNode(int nodeId) const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNode(nodeId);
+	return m_pOverlay != nullptr ? m_pOverlay->GetNode(nodeId) : m_pGraph->GetNode(nodeId);
+}
+
+Vector2 ARAStar::GetNodePos(int nodeId) const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNodePos(nodeId);
+	return m_pOverlay != nullptr ? m_pOverlay->GetNodePos(nodeId) : m_pGraph->GetNodePos(nodeId);
+}
+
+unsigned long long ARAStar::GetVersion() const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetVersion();
+	return m_pOverlay != nullptr ? m_pOverlay->GetBaseGraph()->GetVersion() : m_pGraph->GetVersion();
+}
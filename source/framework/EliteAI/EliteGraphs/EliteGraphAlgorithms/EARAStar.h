@@ -0,0 +1,93 @@
+//*=================================================*/
+// EARAStar.h: Anytime A* (ARA*). The first path is searched with inflated estimates (weighted A*), which is fast but
+// can cost up to that weight times the cheapest path. While there is time the weight is lowered and the search continues
+// from where it was, only nodes whose cost improved are opened again, until the weight reaches 1 and the path is the cheapest.
+// After every path the bound is recomputed from the open nodes, it is often lower than the weight that was used.
+// The estimates have to be consistent (the geometric heuristics are when no connection is cheaper than its length).
+//*=================================================*/
+
+#pragma once
+#include "EAStar.h"
+
+namespace Elite
+{
+	class ARAStar final
+	{
+	public:
+		ARAStar(Graph* const pGraph, Heuristic hFunction);
+		ARAStar(const CompactGraph* const pGraph, Heuristic hFunction);
+		ARAStar(const GraphOverlay* const pGraph, Heuristic hFunction);
+
+		// The first path is searched with initialWeight, every next one with weightStep less until it reaches 1.
+		// Used by the searches that start after this
+		void SetWeights(float initialWeight, float weightStep);
+
+		// Starts a new query, forgets the previous path
+		void BeginSearch(int startNodeId, int goalNodeId);
+		// Continues the search for at most the given time, returns true when it has finished (the path is the cheapest or there is none).
+		// A search that is interrupted by an edit of the graph starts over
+		bool Improve(float maxMicroseconds);
+		bool IsFinished() const { return m_IsFinished; }
+
+		// Searches until the first path is found and keeps improving it for what is left of the time
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, float maxMicroseconds, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int goalNodeId, float maxMicroseconds, std::vector<int>& path);
+
+		// Best path found so far, empty until the first one is found
+		bool HasPath() const { return !m_PathIds.empty(); }
+		const std::vector<int>& GetPathIds() const { return m_PathIds; }
+		void GetPath(std::vector<GraphNode*>& path) const;
+		float GetPathCost() const { return m_PathCost; }
+		// The path costs at most this many times as much as the cheapest one, FLT_MAX before the first path
+		float GetSuboptimalityBound() const { return m_SuboptimalityBound; }
+		// Weight of the estimates in the current search
+		float GetWeight() const { return m_Weight; }
+		// Nodes taken from the open list since BeginSearch
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		void Search(int startNodeId, int goalNodeId, float maxMicroseconds);
+		void ExpandNode(int nodeId);
+		void FinishIteration();
+		void BeginIteration();
+		template<typename Visitor>
+		void VisitConnections(int nodeId, const Visitor& visit) const;
+		float GetConnectionCost(int fromNodeId, int toNodeId) const;
+		float GetHeuristicCost(int nodeId) const;
+		float GetKey(int nodeId) const { return m_Context.GetCostSoFar(nodeId) + m_Weight * GetHeuristicCost(nodeId); }
+
+		int GetNrOfNodeSlots() const;
+		GraphNode* GetNode(int nodeId) const;
+		Vector2 GetNodePos(int nodeId) const;
+		unsigned long long GetVersion() const;
+
+		Graph* m_pGraph = nullptr;
+		const CompactGraph* m_pCompactGraph = nullptr;
+		const GraphOverlay* m_pOverlay = nullptr;
+		Heuristic m_HeuristicFunction;
+		float m_InitialWeight{ 3.f };
+		float m_WeightStep{ 0.5f };
+
+		// state of the current query
+		int m_StartNodeId{ invalid_node_id };
+		int m_GoalNodeId{ invalid_node_id };
+		Vector2 m_GoalPos{};
+		unsigned long long m_Version{ 0 };
+		float m_Weight{ 1.f };
+		bool m_IsFinished{ true };
+		int m_NrOfExpandedNodes{ 0 };
+
+		// every weight is a new iteration, nodes are closed and inconsistent (improved after they were closed)
+		// when their stamp is the current iteration
+		SearchContext m_Context{};
+		unsigned int m_Iteration{ 0 };
+		std::vector<unsigned int> m_ClosedIterations{};
+		std::vector<unsigned int> m_InconsistentIterations{};
+		std::vector<int> m_InconsistentNodeIds{};
+		std::vector<int> m_ReopenNodeIds{};
+
+		std::vector<int> m_PathIds{};
+		float m_PathCost{ FLT_MAX };
+		float m_SuboptimalityBound{ FLT_MAX };
+	};
+}
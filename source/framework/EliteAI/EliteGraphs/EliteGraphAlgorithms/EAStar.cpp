@@ -9,103 +9,81 @@ AStar::AStar(Graph* const pGraph, Heuristic hFunction)
 {
 }
 
-std::vector<GraphNode*>AStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode)
+AStar::AStar(const CompactGraph* const pGraph, Heuristic hFunction)
+	: m_pCompactGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
 {
-	std::vector<GraphNode*> path{};
-	
-	std::vector<NodeRecord> openNodes{};
-	std::vector<NodeRecord> closedNodes{};
-
-	NodeRecord startRecord;
-	startRecord.pNode = pStartNode;
-	startRecord.pConnection = nullptr;
-	startRecord.costSoFar = 0.f;
-	startRecord.estimatedTotalCost = GetHeuristicCost(pStartNode, pGoalNode);
-
-	openNodes.emplace_back(startRecord);
-
-	while (!openNodes.empty())
-	{
-		auto currentIt = std::min_element(openNodes.begin(), openNodes.end(),
-			[](const NodeRecord& a, const NodeRecord& b)
-			{
-				return a.estimatedTotalCost < b.estimatedTotalCost;
-			});
-		NodeRecord currentNode = *currentIt;
+}
 
-		// if we reach the end, reconstruct path
-		if (currentNode.pNode == pGoalNode)
-		{
-			while (currentNode.pConnection != nullptr)
-			{
-				path.push_back(currentNode.pNode);
-				auto fromNode = m_pGraph->GetNode(currentNode.pConnection->GetFromNodeId());
-				auto it = std::find_if(closedNodes.begin(), closedNodes.end(), [&](const NodeRecord& record) { return record.pNode == fromNode; });
-				if (it != closedNodes.end())
-				{
-					currentNode = *it;
-				}
-				else
-				{
-					break;
-				}
-			}
+AStar::AStar(const GraphOverlay* const pGraph, Heuristic hFunction)
+	: m_pOverlay(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+}
 
-			path.emplace_back(pStartNode);
-			std::reverse(path.begin(), path.end());
-			return path;
-		}
+std::vector<GraphNode*> AStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode)
+{
+	std::vector<GraphNode*> path{};
+	FindPath(pStartNode, pGoalNode, path);
+	return path;
+}
 
-		openNodes.erase(currentIt);
-		closedNodes.emplace_back(currentNode);
+std::vector<int> AStar::FindPathIds(int startNodeId, int goalNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, goalNodeId, path);
+	return path;
+}
 
-		auto connections = m_pGraph->GetConnectionsFromNode(currentNode.pNode->GetId());
-		for (GraphConnection* pConnection : connections)
-		{
-			GraphNode* pToNode = m_pGraph->GetNode(pConnection->GetToNodeId());
+void AStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, std::vector<GraphNode*>& path)
+{
+	path.clear();
 
-			float gCost = currentNode.costSoFar + pConnection->GetCost();
+	SearchContext& context = GetSearchContext();
+	if (!Search(pStartNode->GetId(), pGoalNode->GetId(), context))
+		return;
 
-			// check if the node is already in the closed list
-			auto closedIt = std::find_if(closedNodes.begin(), closedNodes.end(), [&](const NodeRecord& record) { return record.pNode == pToNode; });
-			if (closedIt != closedNodes.end())
-			{
-				if (gCost >= closedIt->costSoFar)
-					continue;
-				else
-					// remove this node because a better path is found
-					closedNodes.erase(closedIt);
-			}
+	// reconstruct the path by following the parents back to the start
+	for (int nodeId = pGoalNode->GetId(); nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+		path.push_back(GetNode(nodeId));
+	std::reverse(path.begin(), path.end());
+}
 
-			// check if the node is in the open list
-			auto openIt = std::find_if(openNodes.begin(), openNodes.end(), [&](const NodeRecord& record) { return record.pNode == pToNode; });
-			if (openIt != openNodes.end())
-			{
-				if (gCost >= openIt->costSoFar)
-					continue;
-				else
-					// remove this node because a better path is found
-					openNodes.erase(openIt);
-			}
+void AStar::FindPathIds(int startNodeId, int goalNodeId, std::vector<int>& path)
+{
+	path.clear();
 
-			// Update the record
-			NodeRecord neighborRecord;
-			neighborRecord.pNode = pToNode;
-			neighborRecord.pConnection = pConnection;
-			neighborRecord.costSoFar = gCost;
-			neighborRecord.estimatedTotalCost = gCost + GetHeuristicCost(pToNode, pGoalNode);
-			openNodes.emplace_back(neighborRecord);
-		}
+	SearchContext& context = GetSearchContext();
+	if (!Search(startNodeId, goalNodeId, context))
+		return;
 
-		
+	for (int nodeId = goalNodeId; nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+		path.push_back(nodeId);
+	std::reverse(path.begin(), path.end());
+}
 
-	}
+// Returns true if the goal was reached, the path can then be read from the parents in the context
+bool AStar::Search(int startNodeId, int goalNodeId, SearchContext& context) const
+{
+	if (m_pCompactGraph != nullptr)
+		return Search(CompactGraphView{ m_pCompactGraph }, startNodeId, goalNodeId, context);
+	if (m_pOverlay != nullptr)
+		return Search(GraphOverlayView{ m_pOverlay }, startNodeId, goalNodeId, context);
+	return Search(GraphView{ m_pGraph }, startNodeId, goalNodeId, context);
+}
 
-	return path;
+template<typename GraphViewType>
+bool AStar::Search(const GraphViewType& graph, int startNodeId, int goalNodeId, SearchContext& context) const
+{
+	AStarT<GraphViewType, HeuristicPolicies::Runtime> search{ graph, HeuristicPolicies::Runtime{ m_HeuristicFunction } };
+	search.SetLandmarkHeuristic(m_pLandmarks);
+	search.SetHeuristicWeight(m_HeuristicWeight);
+	return search.Search(startNodeId, goalNodeId, context);
 }
 
-float AStar::GetHeuristicCost(GraphNode* const pStartNode, GraphNode* const pEndNode) const
+GraphNode* AStar::GetNode(int nodeId) const
 {
-	Vector2 toDestination = m_pGraph->GetNodePos(pEndNode->GetId()) - m_pGraph->GetNodePos(pStartNode->GetId());
-	return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
-}
\ No newline at end of file
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNode(nodeId);
+	return m_pOverlay != nullptr ? m_pOverlay->GetNode(nodeId) : m_pGraph->GetNode(nodeId);
+}
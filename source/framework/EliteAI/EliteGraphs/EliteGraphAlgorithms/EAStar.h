@@ -1,45 +1,47 @@
 #pragma once
-#include <algorithm>
-#include "../EliteGraph/EGraph.h"
-#include "../EliteGraph/EGraphConnection.h"
-#include "../EliteGraph/EGraphNode.h"
-#include "EHeuristic.h"
+#include "EAStarT.h"
 
 namespace Elite
 {
+	// AStarT with the heuristic picked at run time, for the callers that choose it at run time.
+	// Use AStarT with a HeuristicPolicy directly when the heuristic is known at compile time
 	class AStar
 	{
 	public:
 		AStar(Graph* const pGraph, Heuristic hFunction);
+		AStar(const CompactGraph* const pGraph, Heuristic hFunction);
+		AStar(const GraphOverlay* const pGraph, Heuristic hFunction);
 
-		// stores the optimal connection to a node and its total costs related to the start and end node of the path
-		struct NodeRecord final
-		{
-			GraphNode* pNode = nullptr;
-			GraphConnection* pConnection = nullptr;
-			float costSoFar = 0.f; // accumulated g-costs of all the connections leading up to this one
-			float estimatedTotalCost = 0.f; // f-cost (= costSoFar + h-cost)
-
-			bool operator==(const NodeRecord& other) const
-			{
-				return pNode == other.pNode
-					&& pConnection == other.pConnection
-					&& costSoFar == other.costSoFar
-					&& estimatedTotalCost == other.estimatedTotalCost;
-			};
-
-			bool operator<(const NodeRecord& other) const
-			{
-				return estimatedTotalCost < other.estimatedTotalCost;
-			};
-		};
+		// Scratch memory for the searches, uses the context of the calling thread when none is set
+		void SetSearchContext(SearchContext* const pContext) { m_pSearchContext = pContext; }
+		// Landmark tables of the searched graph, the estimate is the highest of the landmarks and the heuristic function.
+		// Tables built for another version of the graph are ignored
+		void SetLandmarkHeuristic(const LandmarkHeuristic* const pLandmarks) { m_pLandmarks = pLandmarks; }
+		// Weighted A*, see AStarT::SetHeuristicWeight. ARAStar keeps lowering the weight while there is time
+		void SetHeuristicWeight(float weight) { assert(weight >= 1.f && "AStar: a weight below 1 only slows the search down"); m_HeuristicWeight = weight; }
 
 		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		// Same search, returns node ids. Use this for compact graphs that have no GraphNodes (e.g. loaded from a file)
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+
+		// These overwrite the given path, so a caller that keeps the vector around doesn't allocate per query
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
 
 	private:
-		float GetHeuristicCost(GraphNode* const pStartNode, GraphNode* const pEndNode) const;
+		bool Search(int startNodeId, int goalNodeId, SearchContext& context) const;
+		template<typename GraphViewType>
+		bool Search(const GraphViewType& graph, int startNodeId, int goalNodeId, SearchContext& context) const;
+		SearchContext& GetSearchContext() const { return m_pSearchContext != nullptr ? *m_pSearchContext : SearchContext::GetThreadContext(); }
+
+		GraphNode* GetNode(int nodeId) const;
 
-		Graph* m_pGraph;
+		Graph* m_pGraph = nullptr;
+		const CompactGraph* m_pCompactGraph = nullptr;
+		const GraphOverlay* m_pOverlay = nullptr;
 		Heuristic m_HeuristicFunction;
+		SearchContext* m_pSearchContext = nullptr;
+		const LandmarkHeuristic* m_pLandmarks = nullptr;
+		float m_HeuristicWeight = 1.f;
 	};
-}
\ No newline at end of file
+}
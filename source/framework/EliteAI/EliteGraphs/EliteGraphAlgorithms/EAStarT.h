@@ -0,0 +1,261 @@
+//*=================================================*/
+// EAStarT.h: A* with the graph access and the heuristic as template parameters, so the compiler can inline the
+// connection loop, the node positions and the heuristic instead of calling them through pointers.
+// A graph view has GetNrOfNodeSlots, GetNode, GetNodePos, GetVersion and ForEachConnection(nodeId, visit(toNodeId, cost)),
+// a heuristic policy is a function object on the absolute x and y distance like the Heuristic functions.
+// AStar is this search with the heuristic picked at run time.
+//*=================================================*/
+
+#pragma once
+#include <algorithm>
+#include <limits>
+#include "../EliteGraph/EGraph.h"
+#include "../EliteGraph/EGraphConnection.h"
+#include "../EliteGraph/EGraphNode.h"
+#include "../EliteGraph/ECompactGraph.h"
+#include "../EliteGraph/EGraphOverlay.h"
+#include "EHeuristic.h"
+#include "ELandmarkHeuristic.h"
+#include "ESearchContext.h"
+
+namespace Elite
+{
+	namespace HeuristicPolicies
+	{
+		struct Manhattan { float operator()(float x, float y) const { return HeuristicFunctions::Manhattan(x, y); } };
+		struct Euclidean { float operator()(float x, float y) const { return HeuristicFunctions::Euclidean(x, y); } };
+		struct SqEuclidean { float operator()(float x, float y) const { return HeuristicFunctions::SqEuclidean(x, y); } };
+		struct Octile { float operator()(float x, float y) const { return HeuristicFunctions::Octile(x, y); } };
+		struct Chebyshev { float operator()(float x, float y) const { return HeuristicFunctions::Chebyshev(x, y); } };
+		// Dijkstra
+		struct Zero { float operator()(float, float) const { return 0.f; } };
+
+		// Heuristic that is only known at run time, called through its pointer
+		struct Runtime
+		{
+			Heuristic hFunction;
+			float operator()(float x, float y) const { return hFunction(x, y); }
+		};
+	}
+
+	// Flat arrays, nothing is called through a pointer
+	class CompactGraphView final
+	{
+	public:
+		explicit CompactGraphView(const CompactGraph* const pGraph) : m_pGraph(pGraph) {}
+
+		int GetNrOfNodeSlots() const { return m_pGraph->GetNrOfNodeSlots(); }
+		GraphNode* GetNode(int nodeId) const { return m_pGraph->GetNode(nodeId); }
+		const Vector2& GetNodePos(int nodeId) const { return m_pGraph->GetNodePos(nodeId); }
+		unsigned long long GetVersion() const { return m_pGraph->GetVersion(); }
+
+		template<typename Visitor>
+		void ForEachConnection(int nodeId, const Visitor& visit) const
+		{
+			const int connectionsEnd = m_pGraph->GetConnectionsEnd(nodeId);
+			for (int connectionIdx = m_pGraph->GetConnectionsBegin(nodeId); connectionIdx < connectionsEnd; ++connectionIdx)
+				visit(m_pGraph->GetConnectionTarget(connectionIdx), m_pGraph->GetConnectionCost(connectionIdx));
+		}
+
+	private:
+		const CompactGraph* m_pGraph;
+	};
+
+	// Reads the positions from the nodes instead of the virtual Graph::GetNodePos
+	class GraphView final
+	{
+	public:
+		explicit GraphView(const Graph* const pGraph) : m_pGraph(pGraph) {}
+
+		int GetNrOfNodeSlots() const { return m_pGraph->GetNrOfNodeSlots(); }
+		GraphNode* GetNode(int nodeId) const { return m_pGraph->GetNode(nodeId); }
+		Vector2 GetNodePos(int nodeId) const { return m_pGraph->GetNode(nodeId)->GetPosition(); }
+		unsigned long long GetVersion() const { return m_pGraph->GetVersion(); }
+
+		template<typename Visitor>
+		void ForEachConnection(int nodeId, const Visitor& visit) const
+		{
+			for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(nodeId))
+				visit(pConnection->GetToNodeId(), pConnection->GetCost());
+		}
+
+	private:
+		const Graph* m_pGraph;
+	};
+
+	class GraphOverlayView final
+	{
+	public:
+		explicit GraphOverlayView(const GraphOverlay* const pGraph) : m_pGraph(pGraph) {}
+
+		int GetNrOfNodeSlots() const { return m_pGraph->GetNrOfNodeSlots(); }
+		GraphNode* GetNode(int nodeId) const { return m_pGraph->GetNode(nodeId); }
+		Vector2 GetNodePos(int nodeId) const { return m_pGraph->GetNodePos(nodeId); }
+		unsigned long long GetVersion() const { return m_pGraph->GetBaseGraph()->GetVersion(); }
+
+		// an overlay adds its own connections on top of the ones of the graph below it
+		template<typename Visitor>
+		void ForEachConnection(int nodeId, const Visitor& visit) const
+		{
+			for (const GraphConnection* const pConnection : m_pGraph->GetBaseConnectionsFromNode(nodeId))
+				visit(pConnection->GetToNodeId(), pConnection->GetCost());
+			for (const GraphConnection* const pConnection : m_pGraph->GetOverlayConnectionsFromNode(nodeId))
+				visit(pConnection->GetToNodeId(), pConnection->GetCost());
+		}
+
+	private:
+		const GraphOverlay* m_pGraph;
+	};
+
+	// Progress of a search that is continued in steps
+	enum class SearchStatus
+	{
+		InProgress,
+		Found, // the parents in the context lead from the goal back to the start
+		NotFound
+	};
+
+	template<typename GraphViewType, typename HeuristicPolicy>
+	class AStarT final
+	{
+	public:
+		explicit AStarT(const GraphViewType& graph, const HeuristicPolicy& heuristic = HeuristicPolicy{})
+			: m_Graph(graph)
+			, m_Heuristic(heuristic)
+		{
+		}
+
+		// Scratch memory for the searches, uses the context of the calling thread when none is set
+		void SetSearchContext(SearchContext* const pContext) { m_pSearchContext = pContext; }
+		// Landmark tables of the searched graph, the estimate is the highest of the landmarks and the heuristic.
+		// Tables built for another version of the graph are ignored
+		void SetLandmarkHeuristic(const LandmarkHeuristic* const pLandmarks) { m_pLandmarks = pLandmarks; }
+		// Weighted A*: the estimates are multiplied by the weight. Above 1 fewer nodes are expanded and the path
+		// costs at most weight times as much as the cheapest one
+		void SetHeuristicWeight(float weight) { assert(weight >= 1.f && "AStarT: a weight below 1 only slows the search down"); m_HeuristicWeight = weight; }
+
+		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode)
+		{
+			std::vector<GraphNode*> path{};
+			FindPath(pStartNode, pGoalNode, path);
+			return path;
+		}
+
+		std::vector<int> FindPathIds(int startNodeId, int goalNodeId)
+		{
+			std::vector<int> path{};
+			FindPathIds(startNodeId, goalNodeId, path);
+			return path;
+		}
+
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, std::vector<GraphNode*>& path)
+		{
+			path.clear();
+
+			SearchContext& context = GetSearchContext();
+			if (!Search(pStartNode->GetId(), pGoalNode->GetId(), context))
+				return;
+
+			// reconstruct the path by following the parents back to the start
+			for (int nodeId = pGoalNode->GetId(); nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+				path.push_back(m_Graph.GetNode(nodeId));
+			std::reverse(path.begin(), path.end());
+		}
+
+		void FindPathIds(int startNodeId, int goalNodeId, std::vector<int>& path)
+		{
+			path.clear();
+
+			SearchContext& context = GetSearchContext();
+			if (!Search(startNodeId, goalNodeId, context))
+				return;
+
+			for (int nodeId = goalNodeId; nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+				path.push_back(nodeId);
+			std::reverse(path.begin(), path.end());
+		}
+
+		// Returns true if the goal was reached, the path can then be read from the parents in the context
+		bool Search(int startNodeId, int goalNodeId, SearchContext& context) const
+		{
+			BeginSearch(startNodeId, goalNodeId, context);
+			int nrOfExpansions = 0;
+			return Step(context, (std::numeric_limits<int>::max)(), nrOfExpansions) == SearchStatus::Found;
+		}
+
+		// Search split up so it can be spread over several frames: BeginSearch puts the start on the open list of the context,
+		// every Step continues it for at most maxNrOfExpansions nodes. The graph must not change in between, start over when it does
+		void BeginSearch(int startNodeId, int goalNodeId, SearchContext& context) const
+		{
+			context.BeginSearch(m_Graph.GetNrOfNodeSlots());
+			context.SetGoalNodeId(goalNodeId);
+
+			const float heuristicCost = GetHeuristicCost(startNodeId, goalNodeId, m_Graph.GetNodePos(goalNodeId), GetUsableLandmarks());
+			context.SetReached(startNodeId, 0.f, invalid_node_id);
+			context.UpdateClosestNode(startNodeId, heuristicCost);
+			context.GetOpenList().Push(startNodeId, heuristicCost);
+		}
+
+		// Adds the nodes it expanded to nrOfExpansions. While in progress, the parents lead back from context.GetClosestNodeId()
+		SearchStatus Step(SearchContext& context, int maxNrOfExpansions, int& nrOfExpansions) const
+		{
+			IndexedPriorityQueue& openNodes = context.GetOpenList();
+			if (openNodes.IsEmpty())
+				return SearchStatus::NotFound;
+
+			const int goalNodeId = context.GetGoalNodeId();
+			const Vector2 goalPos = m_Graph.GetNodePos(goalNodeId);
+			const LandmarkHeuristic* const pLandmarks = GetUsableLandmarks();
+
+			for (int expansion = 0; expansion < maxNrOfExpansions; ++expansion)
+			{
+				if (openNodes.IsEmpty())
+					return SearchStatus::NotFound;
+
+				const int currentNodeId = openNodes.Pop();
+				++nrOfExpansions;
+				if (currentNodeId == goalNodeId)
+					return SearchStatus::Found;
+
+				const float currentCostSoFar = context.GetCostSoFar(currentNodeId);
+				m_Graph.ForEachConnection(currentNodeId, [&](int toNodeId, float connectionCost)
+					{
+						// only continue if this is a better path to the node (this also reopens closed nodes)
+						const float gCost = currentCostSoFar + connectionCost;
+						if (gCost >= context.GetCostSoFar(toNodeId))
+							return;
+
+						const float heuristicCost = GetHeuristicCost(toNodeId, goalNodeId, goalPos, pLandmarks);
+						context.SetReached(toNodeId, gCost, currentNodeId);
+						context.UpdateClosestNode(toNodeId, heuristicCost);
+						openNodes.Push(toNodeId, gCost + heuristicCost);
+					});
+			}
+
+			return openNodes.IsEmpty() ? SearchStatus::NotFound : SearchStatus::InProgress;
+		}
+
+		const GraphViewType& GetGraph() const { return m_Graph; }
+		SearchContext& GetSearchContext() const { return m_pSearchContext != nullptr ? *m_pSearchContext : SearchContext::GetThreadContext(); }
+
+	private:
+		float GetHeuristicCost(int nodeId, int goalNodeId, const Vector2& goalPos, const LandmarkHeuristic* const pLandmarks) const
+		{
+			const Vector2 toDestination = goalPos - m_Graph.GetNodePos(nodeId);
+			const float cost = m_Heuristic(abs(toDestination.x), abs(toDestination.y));
+			return m_HeuristicWeight * (pLandmarks != nullptr ? std::max(cost, pLandmarks->GetCost(nodeId, goalNodeId)) : cost);
+		}
+
+		// after an edit the tables could overestimate, so they are only used for the version they were built for
+		const LandmarkHeuristic* GetUsableLandmarks() const
+		{
+			return m_pLandmarks != nullptr && m_pLandmarks->GetVersion() == m_Graph.GetVersion() ? m_pLandmarks : nullptr;
+		}
+
+		GraphViewType m_Graph;
+		HeuristicPolicy m_Heuristic;
+		SearchContext* m_pSearchContext = nullptr;
+		const LandmarkHeuristic* m_pLandmarks = nullptr;
+		float m_HeuristicWeight = 1.f;
+	};
+}
@@ -4,6 +4,7 @@
 #include "../EliteGraph/EGraph.h"
 #include "../EliteGraph/EGraphNode.h"
 #include "../EliteGraph/EGraphConnection.h"
+#include "../EliteGraph/ECompactGraph.h"
 
 using namespace Elite;
 
@@ -12,49 +13,89 @@ BFS::BFS(Graph* const pGraph)
 {
 }
 
+BFS::BFS(const CompactGraph* const pGraph)
+	: m_pCompactGraph(pGraph)
+{
+}
+
 //Breath First Search Algorithm searches for a path from the startNode to the destinationNode
 std::vector<GraphNode*> BFS::FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode)
 {
-	std::queue<GraphNode*> openList = {};
-	std::map<GraphNode*, GraphNode*> closedList = {};
+	std::vector<GraphNode*> path{};
+	FindPath(pStartNode, pDestinationNode, path);
+	return path;
+}
 
-	openList.push(pStartNode);
+std::vector<int> BFS::FindPathIds(int startNodeId, int destinationNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, destinationNodeId, path);
+	return path;
+}
 
-	while (!openList.empty())
-	{
-		GraphNode* const pCurrentNode = openList.front();
-		openList.pop();
+void BFS::FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path)
+{
+	path.clear();
 
-		if (pCurrentNode == pDestinationNode) break;
+	SearchContext& context = GetSearchContext();
+	if (!Search(pStartNode->GetId(), pDestinationNode->GetId(), context))
+		return;
 
-		for (GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(pCurrentNode->GetId()))
-		{
-			GraphNode* const pNextNode = m_pGraph->GetNode(pConnection->GetToNodeId());
+	for (int nodeId = pDestinationNode->GetId(); nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+		path.push_back(m_pCompactGraph != nullptr ? m_pCompactGraph->GetNode(nodeId) : m_pGraph->GetNode(nodeId));
+	std::reverse(path.begin(), path.end());
+}
 
-			if (closedList.find(pNextNode) == closedList.end())
-			{
-				openList.push(pNextNode);
-				closedList[pNextNode] = pCurrentNode;
-			}
+void BFS::FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path)
+{
+	path.clear();
 
-		}
+	SearchContext& context = GetSearchContext();
+	if (!Search(startNodeId, destinationNodeId, context))
+		return;
 
-	} 
+	for (int nodeId = destinationNodeId; nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+		path.push_back(nodeId);
+	std::reverse(path.begin(), path.end());
+}
 
-	std::vector<GraphNode*> path{};
-	GraphNode* pCurrentNode = pDestinationNode;
+// Returns true if the destination was reached, the path can then be read from the parents in the context
+bool BFS::Search(int startNodeId, int destinationNodeId, SearchContext& context) const
+{
+	context.BeginSearch(m_pCompactGraph != nullptr ? m_pCompactGraph->GetNrOfNodeSlots() : m_pGraph->GetNrOfNodeSlots());
+
+	context.SetReached(startNodeId, 0.f, invalid_node_id);
+	context.PushQueue(startNodeId);
 
-	while (pCurrentNode != pStartNode)
+	while (!context.IsQueueEmpty())
 	{
-		path.push_back(pCurrentNode);
-		pCurrentNode = closedList.at(pCurrentNode);
+		const int currentNodeId = context.PopQueue();
+		if (currentNodeId == destinationNodeId)
+			return true;
 
-	}
-	path.push_back(pStartNode);
-	std::reverse(path.begin(), path.end());
-	
+		// the cost of a node is the number of connections it is away from the start
+		const float nextCost = context.GetCostSoFar(currentNodeId) + 1.f;
+		auto visitNode = [&](int nextNodeId)
+			{
+				if (context.IsReached(nextNodeId))
+					return;
 
+				context.SetReached(nextNodeId, nextCost, currentNodeId);
+				context.PushQueue(nextNodeId);
+			};
 
+		if (m_pCompactGraph != nullptr)
+		{
+			const int connectionsEnd = m_pCompactGraph->GetConnectionsEnd(currentNodeId);
+			for (int connectionIdx = m_pCompactGraph->GetConnectionsBegin(currentNodeId); connectionIdx < connectionsEnd; ++connectionIdx)
+				visitNode(m_pCompactGraph->GetConnectionTarget(connectionIdx));
+		}
+		else
+		{
+			for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(currentNodeId))
+				visitNode(pConnection->GetToNodeId());
+		}
+	}
 
-	return path;
-}
\ No newline at end of file
+	return false;
+}
@@ -1,19 +1,36 @@
 #pragma once
+#include "ESearchContext.h"
 
 namespace Elite
 {
 	class Graph;
 	class GraphNode;
+	class CompactGraph;
 
 	class BFS
 	{
 	public:
 		BFS(Graph* const pGraph);
+		BFS(const CompactGraph* const pGraph);
+
+		// Scratch memory for the searches, uses the context of the calling thread when none is set
+		void SetSearchContext(SearchContext* const pContext) { m_pSearchContext = pContext; }
 
 		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		// Same search, returns node ids. Use this for compact graphs that have no GraphNodes (e.g. loaded from a file)
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+
+		// These overwrite the given path, so a caller that keeps the vector around doesn't allocate per query
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
 
 	private:
-		Graph* m_pGraph;
+		bool Search(int startNodeId, int destinationNodeId, SearchContext& context) const;
+		SearchContext& GetSearchContext() const { return m_pSearchContext != nullptr ? *m_pSearchContext : SearchContext::GetThreadContext(); }
+
+		Graph* m_pGraph = nullptr;
+		const CompactGraph* m_pCompactGraph = nullptr;
+		SearchContext* m_pSearchContext = nullptr;
 	};
 
 }
@@ -0,0 +1,197 @@
+#include "stdafx.h"
+#include "EBidirectionalAStar.h"
+
+using namespace Elite;
+
+BidirectionalAStar::BidirectionalAStar(Graph* const pGraph, Heuristic hFunction)
+	: m_pGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+	if (m_pGraph->IsDirectional() && !m_pGraph->IsTrackingIncomingConnections())
+		m_pGraph->SetTrackIncomingConnections(true);
+}
+
+BidirectionalAStar::BidirectionalAStar(const CompactGraph* const pGraph, Heuristic hFunction)
+	: m_pCompactGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+	assert(!pGraph->IsDirectional() && "BidirectionalAStar: compact graphs have no incoming connections, only undirected ones can be searched backwards");
+}
+
+BidirectionalAStar::BidirectionalAStar(const GraphOverlay* const pGraph, Heuristic hFunction)
+	: m_pOverlay(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+	assert(!pGraph->IsDirectional() && "BidirectionalAStar: overlays have no incoming connections, only undirected ones can be searched backwards");
+}
+
+void BidirectionalAStar::SetSearchContexts(SearchContext* const pForwardContext, SearchContext* const pBackwardContext)
+{
+	assert((pForwardContext == nullptr || pForwardContext != pBackwardContext) && "BidirectionalAStar: both sides need their own context");
+	m_pForwardContext = pForwardContext;
+	m_pBackwardContext = pBackwardContext;
+}
+
+std::vector<GraphNode*> BidirectionalAStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode)
+{
+	std::vector<GraphNode*> path{};
+	FindPath(pStartNode, pGoalNode, path);
+	return path;
+}
+
+std::vector<int> BidirectionalAStar::FindPathIds(int startNodeId, int goalNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, goalNodeId, path);
+	return path;
+}
+
+void BidirectionalAStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, std::vector<GraphNode*>& path)
+{
+	FindPathIds(pStartNode->GetId(), pGoalNode->GetId(), m_PathIds);
+
+	path.clear();
+	for (int nodeId : m_PathIds)
+		path.push_back(GetNode(nodeId));
+}
+
+void BidirectionalAStar::FindPathIds(int startNodeId, int goalNodeId, std::vector<int>& path)
+{
+	path.clear();
+
+	SearchContext& forwardContext = GetForwardContext();
+	SearchContext& backwardContext = GetBackwardContext();
+	const int meetingNodeId = Search(startNodeId, goalNodeId, forwardContext, backwardContext);
+	if (meetingNodeId == invalid_node_id)
+		return;
+
+	// from the start to the meeting node, then on to the goal
+	for (int nodeId = meetingNodeId; nodeId != invalid_node_id; nodeId = forwardContext.GetParent(nodeId))
+		path.push_back(nodeId);
+	std::reverse(path.begin(), path.end());
+	for (int nodeId = backwardContext.GetParent(meetingNodeId); nodeId != invalid_node_id; nodeId = backwardContext.GetParent(nodeId))
+		path.push_back(nodeId);
+}
+
+// Returns the node where the cheapest path goes from the forward to the backward search, invalid_node_id if there is no path
+int BidirectionalAStar::Search(int startNodeId, int goalNodeId, SearchContext& forwardContext, SearchContext& backwardContext)
+{
+	m_NrOfExpandedNodes = 0;
+
+	forwardContext.BeginSearch(GetNrOfNodeSlots());
+	backwardContext.BeginSearch(GetNrOfNodeSlots());
+	IndexedPriorityQueue& forwardOpenNodes = forwardContext.GetOpenList();
+	IndexedPriorityQueue& backwardOpenNodes = backwardContext.GetOpenList();
+
+	const Vector2 startPos = GetNodePos(startNodeId);
+	const Vector2 goalPos = GetNodePos(goalNodeId);
+	forwardContext.SetReached(startNodeId, 0.f, invalid_node_id);
+	forwardOpenNodes.Push(startNodeId, GetPotential(startNodeId, startPos, goalPos));
+	backwardContext.SetReached(goalNodeId, 0.f, invalid_node_id);
+	backwardOpenNodes.Push(goalNodeId, -GetPotential(goalNodeId, startPos, goalPos));
+
+	if (startNodeId == goalNodeId)
+		return startNodeId;
+
+	float bestCost = FLT_MAX;
+	int meetingNodeId = invalid_node_id;
+	while (!forwardOpenNodes.IsEmpty() && !backwardOpenNodes.IsEmpty())
+	{
+		// both sides search the same graph with the costs reduced by the potentials, like a bidirectional Dijkstra
+		// no path that is still open can be cheaper than the best one once the lowest keys add up to its cost
+		if (forwardOpenNodes.GetTopPriority() + backwardOpenNodes.GetTopPriority() >= bestCost)
+			break;
+
+		const bool isBackward = backwardOpenNodes.GetSize() < forwardOpenNodes.GetSize();
+		SearchContext& context = isBackward ? backwardContext : forwardContext;
+		const SearchContext& otherContext = isBackward ? forwardContext : backwardContext;
+		IndexedPriorityQueue& openNodes = context.GetOpenList();
+		const Vector2& targetPos = isBackward ? startPos : goalPos;
+		const float potentialSign = isBackward ? -1.f : 1.f;
+
+		const int currentNodeId = openNodes.Pop();
+		const float currentCostSoFar = context.GetCostSoFar(currentNodeId);
+		++m_NrOfExpandedNodes;
+
+		VisitConnections(currentNodeId, isBackward, [&](int nextNodeId, float connectionCost)
+			{
+				const float gCost = currentCostSoFar + connectionCost;
+				if (gCost >= context.GetCostSoFar(nextNodeId))
+					return;
+
+				context.SetReached(nextNodeId, gCost, currentNodeId);
+				if (otherContext.IsReached(nextNodeId) && gCost + otherContext.GetCostSoFar(nextNodeId) < bestCost)
+				{
+					bestCost = gCost + otherContext.GetCostSoFar(nextNodeId);
+					meetingNodeId = nextNodeId;
+				}
+
+				// a node that can't beat the best path doesn't have to be expanded
+				if (gCost + GetHeuristicCost(nextNodeId, targetPos) < bestCost)
+					openNodes.Push(nextNodeId, gCost + potentialSign * GetPotential(nextNodeId, startPos, goalPos));
+			});
+	}
+
+	return meetingNodeId;
+}
+
+template<typename Visitor>
+void BidirectionalAStar::VisitConnections(int nodeId, bool isBackward, const Visitor& visit) const
+{
+	if (m_pCompactGraph != nullptr)
+	{
+		const int connectionsEnd = m_pCompactGraph->GetConnectionsEnd(nodeId);
+		for (int connectionIdx = m_pCompactGraph->GetConnectionsBegin(nodeId); connectionIdx < connectionsEnd; ++connectionIdx)
+			visit(m_pCompactGraph->GetConnectionTarget(connectionIdx), m_pCompactGraph->GetConnectionCost(connectionIdx));
+	}
+	else if (m_pOverlay != nullptr)
+	{
+		for (const GraphConnection* const pConnection : m_pOverlay->GetBaseConnectionsFromNode(nodeId))
+			visit(pConnection->GetToNodeId(), pConnection->GetCost());
+		for (const GraphConnection* const pConnection : m_pOverlay->GetOverlayConnectionsFromNode(nodeId))
+			visit(pConnection->GetToNodeId(), pConnection->GetCost());
+	}
+	else if (isBackward && m_pGraph->IsDirectional())
+	{
+		for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsToNode(nodeId))
+			visit(pConnection->GetFromNodeId(), pConnection->GetCost());
+	}
+	else
+	{
+		for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(nodeId))
+			visit(pConnection->GetToNodeId(), pConnection->GetCost());
+	}
+}
+
+float BidirectionalAStar::GetHeuristicCost(int nodeId, const Vector2& targetPos) const
+{
+	Vector2 toTarget = targetPos - GetNodePos(nodeId);
+	return m_HeuristicFunction(abs(toTarget.x), abs(toTarget.y));
+}
+
+// Average of the estimates of both sides, the backward search uses minus this so they agree on the reduced costs
+float BidirectionalAStar::GetPotential(int nodeId, const Vector2& startPos, const Vector2& goalPos) const
+{
+	return 0.5f * (GetHeuristicCost(nodeId, goalPos) - GetHeuristicCost(nodeId, startPos));
+}
+
+int BidirectionalAStar::GetNrOfNodeSlots() const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNrOfNodeSlots();
+	return m_pOverlay != nullptr ? m_pOverlay->GetNrOfNodeSlots() : m_pGraph->GetNrOfNodeSlots();
+}
+
+GraphNode* BidirectionalAStar::GetNode(int nodeId) const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNode(nodeId);
+	return m_pOverlay != nullptr ? m_pOverlay->GetNode(nodeId) : m_pGraph->GetNode(nodeId);
+}
+
+Vector2 BidirectionalAStar::GetNodePos(int nodeId) const
+{
+	if (m_pCompactGraph != nullptr)
+		return m_pCompactGraph->GetNodePos(nodeId);
+	return m_pOverlay != nullptr ? m_pOverlay->GetNodePos(nodeId) : m_pGraph->GetNodePos(nodeId);
+}
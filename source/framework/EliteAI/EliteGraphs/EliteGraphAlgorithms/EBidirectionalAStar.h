@@ -0,0 +1,60 @@
+//*=================================================*/
+// EBidirectionalAStar.h: A* from the start and from the destination at the same time, each side expands
+// towards the other one and the path is joined where they meet. The side with the smaller open list is expanded first.
+// Both sides use the average of the two estimates as potential, so they agree on the reduced cost of every connection
+// and the search can stop as soon as the lowest keys of both open lists add up to the cost of the best meeting.
+// This needs a consistent heuristic (the geometric ones are when no connection is cheaper than its length).
+// Backward steps follow the connections into a node: the incoming connections of a directed Graph, the connections
+// themselves on undirected graphs (compact graphs and overlays have to be undirected).
+//*=================================================*/
+
+#pragma once
+#include "EAStar.h"
+
+namespace Elite
+{
+	class BidirectionalAStar final
+	{
+	public:
+		// The backward side of a directed Graph needs its incoming connections, so they stay tracked on that graph after this
+		// (a second connection list per node and more work per edit). Undirected graphs are not changed
+		BidirectionalAStar(Graph* const pGraph, Heuristic hFunction);
+		BidirectionalAStar(const CompactGraph* const pGraph, Heuristic hFunction);
+		BidirectionalAStar(const GraphOverlay* const pGraph, Heuristic hFunction);
+
+		// Scratch memory for both sides, uses the contexts of the calling thread when none are set
+		void SetSearchContexts(SearchContext* const pForwardContext, SearchContext* const pBackwardContext);
+
+		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
+
+		// Nodes taken from both open lists during the last search
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		int Search(int startNodeId, int goalNodeId, SearchContext& forwardContext, SearchContext& backwardContext);
+		template<typename Visitor>
+		void VisitConnections(int nodeId, bool isBackward, const Visitor& visit) const;
+		float GetHeuristicCost(int nodeId, const Vector2& targetPos) const;
+		float GetPotential(int nodeId, const Vector2& startPos, const Vector2& goalPos) const;
+
+		SearchContext& GetForwardContext() const { return m_pForwardContext != nullptr ? *m_pForwardContext : SearchContext::GetThreadContext(); }
+		SearchContext& GetBackwardContext() const { return m_pBackwardContext != nullptr ? *m_pBackwardContext : SearchContext::GetThreadBackwardContext(); }
+
+		int GetNrOfNodeSlots() const;
+		GraphNode* GetNode(int nodeId) const;
+		Vector2 GetNodePos(int nodeId) const;
+
+		Graph* m_pGraph = nullptr;
+		const CompactGraph* m_pCompactGraph = nullptr;
+		const GraphOverlay* m_pOverlay = nullptr;
+		Heuristic m_HeuristicFunction;
+		SearchContext* m_pForwardContext = nullptr;
+		SearchContext* m_pBackwardContext = nullptr;
+
+		int m_NrOfExpandedNodes{ 0 };
+		std::vector<int> m_PathIds{};
+	};
+}
@@ -0,0 +1,136 @@
+#include "stdafx.h"
+#include "EBidirectionalBFS.h"
+
+#include "../EliteGraph/EGraph.h"
+#include "../EliteGraph/EGraphNode.h"
+#include "../EliteGraph/EGraphConnection.h"
+#include "../EliteGraph/ECompactGraph.h"
+
+using namespace Elite;
+
+BidirectionalBFS::BidirectionalBFS(Graph* const pGraph)
+	: m_pGraph(pGraph)
+{
+	if (m_pGraph->IsDirectional() && !m_pGraph->IsTrackingIncomingConnections())
+		m_pGraph->SetTrackIncomingConnections(true);
+}
+
+BidirectionalBFS::BidirectionalBFS(const CompactGraph* const pGraph)
+	: m_pCompactGraph(pGraph)
+{
+	assert(!pGraph->IsDirectional() && "BidirectionalBFS: compact graphs have no incoming connections, only undirected ones can be searched backwards");
+}
+
+void BidirectionalBFS::SetSearchContexts(SearchContext* const pForwardContext, SearchContext* const pBackwardContext)
+{
+	assert((pForwardContext == nullptr || pForwardContext != pBackwardContext) && "BidirectionalBFS: both sides need their own context");
+	m_pForwardContext = pForwardContext;
+	m_pBackwardContext = pBackwardContext;
+}
+
+std::vector<GraphNode*> BidirectionalBFS::FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode)
+{
+	std::vector<GraphNode*> path{};
+	FindPath(pStartNode, pDestinationNode, path);
+	return path;
+}
+
+std::vector<int> BidirectionalBFS::FindPathIds(int startNodeId, int destinationNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, destinationNodeId, path);
+	return path;
+}
+
+void BidirectionalBFS::FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path)
+{
+	FindPathIds(pStartNode->GetId(), pDestinationNode->GetId(), m_PathIds);
+
+	path.clear();
+	for (int nodeId : m_PathIds)
+		path.push_back(m_pCompactGraph != nullptr ? m_pCompactGraph->GetNode(nodeId) : m_pGraph->GetNode(nodeId));
+}
+
+void BidirectionalBFS::FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path)
+{
+	path.clear();
+
+	SearchContext& forwardContext = GetForwardContext();
+	SearchContext& backwardContext = GetBackwardContext();
+	const int meetingNodeId = Search(startNodeId, destinationNodeId, forwardContext, backwardContext);
+	if (meetingNodeId == invalid_node_id)
+		return;
+
+	for (int nodeId = meetingNodeId; nodeId != invalid_node_id; nodeId = forwardContext.GetParent(nodeId))
+		path.push_back(nodeId);
+	std::reverse(path.begin(), path.end());
+	for (int nodeId = backwardContext.GetParent(meetingNodeId); nodeId != invalid_node_id; nodeId = backwardContext.GetParent(nodeId))
+		path.push_back(nodeId);
+}
+
+// Returns the node where the shortest path goes from the forward to the backward search, invalid_node_id if there is no path
+int BidirectionalBFS::Search(int startNodeId, int destinationNodeId, SearchContext& forwardContext, SearchContext& backwardContext) const
+{
+	const int nrOfNodeSlots = m_pCompactGraph != nullptr ? m_pCompactGraph->GetNrOfNodeSlots() : m_pGraph->GetNrOfNodeSlots();
+	forwardContext.BeginSearch(nrOfNodeSlots);
+	backwardContext.BeginSearch(nrOfNodeSlots);
+
+	forwardContext.SetReached(startNodeId, 0.f, invalid_node_id);
+	forwardContext.PushQueue(startNodeId);
+	backwardContext.SetReached(destinationNodeId, 0.f, invalid_node_id);
+	backwardContext.PushQueue(destinationNodeId);
+
+	if (startNodeId == destinationNodeId)
+		return startNodeId;
+
+	int meetingNodeId = invalid_node_id;
+	float bestCost = FLT_MAX;
+	while (!forwardContext.IsQueueEmpty() && !backwardContext.IsQueueEmpty())
+	{
+		const bool isBackward = backwardContext.GetQueueSize() < forwardContext.GetQueueSize();
+		SearchContext& context = isBackward ? backwardContext : forwardContext;
+		const SearchContext& otherContext = isBackward ? forwardContext : backwardContext;
+
+		// a meeting can only be trusted to be the shortest once the whole layer has been looked at
+		for (int nrOfLayerNodes = context.GetQueueSize(); nrOfLayerNodes > 0; --nrOfLayerNodes)
+		{
+			const int currentNodeId = context.PopQueue();
+			const float nextCost = context.GetCostSoFar(currentNodeId) + 1.f;
+			auto visitNode = [&](int nextNodeId)
+				{
+					if (context.IsReached(nextNodeId))
+						return;
+
+					context.SetReached(nextNodeId, nextCost, currentNodeId);
+					context.PushQueue(nextNodeId);
+					if (otherContext.IsReached(nextNodeId) && nextCost + otherContext.GetCostSoFar(nextNodeId) < bestCost)
+					{
+						bestCost = nextCost + otherContext.GetCostSoFar(nextNodeId);
+						meetingNodeId = nextNodeId;
+					}
+				};
+
+			if (m_pCompactGraph != nullptr)
+			{
+				const int connectionsEnd = m_pCompactGraph->GetConnectionsEnd(currentNodeId);
+				for (int connectionIdx = m_pCompactGraph->GetConnectionsBegin(currentNodeId); connectionIdx < connectionsEnd; ++connectionIdx)
+					visitNode(m_pCompactGraph->GetConnectionTarget(connectionIdx));
+			}
+			else if (isBackward && m_pGraph->IsDirectional())
+			{
+				for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsToNode(currentNodeId))
+					visitNode(pConnection->GetFromNodeId());
+			}
+			else
+			{
+				for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(currentNodeId))
+					visitNode(pConnection->GetToNodeId());
+			}
+		}
+
+		if (meetingNodeId != invalid_node_id)
+			return meetingNodeId;
+	}
+
+	return invalid_node_id;
+}
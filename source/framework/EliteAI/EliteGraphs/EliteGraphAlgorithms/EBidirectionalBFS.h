@@ -0,0 +1,44 @@
+//*=================================================*/
+// EBidirectionalBFS.h: Breadth first search from the start and from the destination at the same time.
+// The side with the smaller queue expands a whole layer at a time, the first layer where both sides meet holds the
+// path with the fewest connections. Backward steps follow the incoming connections of a directed Graph.
+//*=================================================*/
+
+#pragma once
+#include "ESearchContext.h"
+
+namespace Elite
+{
+	class Graph;
+	class GraphNode;
+	class CompactGraph;
+
+	class BidirectionalBFS
+	{
+	public:
+		// Turns on incoming connection tracking for a directed Graph and leaves it on, the graph keeps a second
+		// connection list per node from then on. Undirected graphs are not changed
+		BidirectionalBFS(Graph* const pGraph);
+		// Compact graphs have no incoming connections, so only undirected ones can be searched
+		BidirectionalBFS(const CompactGraph* const pGraph);
+
+		// Scratch memory for both sides, uses the contexts of the calling thread when none are set
+		void SetSearchContexts(SearchContext* const pForwardContext, SearchContext* const pBackwardContext);
+
+		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
+
+	private:
+		int Search(int startNodeId, int destinationNodeId, SearchContext& forwardContext, SearchContext& backwardContext) const;
+		SearchContext& GetForwardContext() const { return m_pForwardContext != nullptr ? *m_pForwardContext : SearchContext::GetThreadContext(); }
+		SearchContext& GetBackwardContext() const { return m_pBackwardContext != nullptr ? *m_pBackwardContext : SearchContext::GetThreadBackwardContext(); }
+
+		Graph* m_pGraph = nullptr;
+		const CompactGraph* m_pCompactGraph = nullptr;
+		SearchContext* m_pForwardContext = nullptr;
+		SearchContext* m_pBackwardContext = nullptr;
+		std::vector<int> m_PathIds{};
+	};
+}
@@ -0,0 +1,215 @@
+#include "stdafx.h"
+#include "EDStarLite.h"
+
+using namespace Elite;
+
+DStarLite::DStarLite(Graph* const pGraph, Heuristic hFunction)
+	: m_pGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
+{
+	if (m_pGraph->IsDirectional() && !m_pGraph->IsTrackingIncomingConnections())
+		m_pGraph->SetTrackIncomingConnections(true);
+}
+
+void DStarLite::Initialize(int startNodeId, int goalNodeId)
+{
+	m_StartNodeId = startNodeId;
+	m_GoalNodeId = goalNodeId;
+	m_LastStartNodeId = startNodeId;
+	m_KeyModifier = 0.f;
+	m_Version = m_pGraph->GetVersion();
+
+	const int nrOfNodeSlots = m_pGraph->GetNrOfNodeSlots();
+	m_Costs.assign(nrOfNodeSlots, FLT_MAX);
+	m_LookaheadCosts.assign(nrOfNodeSlots, FLT_MAX);
+	m_OpenNodes.Resize(nrOfNodeSlots);
+
+	if (!m_pGraph->IsNodeValid(m_StartNodeId) || !m_pGraph->IsNodeValid(m_GoalNodeId))
+		return;
+
+	m_LookaheadCosts[m_GoalNodeId] = 0.f;
+	m_OpenNodes.Push(m_GoalNodeId, GetKey(m_GoalNodeId));
+}
+
+void DStarLite::SetStart(int startNodeId)
+{
+	m_StartNodeId = startNodeId;
+}
+
+void DStarLite::SetHeuristicFunction(Heuristic hFunction)
+{
+	if (hFunction == m_HeuristicFunction)
+		return;
+
+	m_HeuristicFunction = hFunction;
+	if (IsInitialized())
+		Initialize(m_StartNodeId, m_GoalNodeId);
+}
+
+void DStarLite::FindPath(std::vector<GraphNode*>& path)
+{
+	FindPathIds(m_PathIds);
+
+	path.clear();
+	for (int nodeId : m_PathIds)
+		path.push_back(m_pGraph->GetNode(nodeId));
+}
+
+void DStarLite::FindPathIds(std::vector<int>& path)
+{
+	path.clear();
+	m_NrOfExpandedNodes = 0;
+	if (!IsInitialized())
+		return;
+
+	if (!m_pGraph->IsNodeValid(m_StartNodeId) || !m_pGraph->IsNodeValid(m_GoalNodeId))
+		return;
+
+	// a start that was added after the search began isn't in the arrays yet
+	if (m_StartNodeId >= static_cast<int>(m_Costs.size()))
+		Initialize(m_StartNodeId, m_GoalNodeId);
+
+	if (m_StartNodeId != m_LastStartNodeId)
+	{
+		// the keys already in the open list are too high by at most this much, adding it to the new keys keeps the order
+		m_KeyModifier += GetHeuristicCost(m_LastStartNodeId, m_StartNodeId);
+		m_LastStartNodeId = m_StartNodeId;
+	}
+
+	ApplyGraphChanges();
+	ComputeShortestPath();
+
+	if (m_Costs[m_StartNodeId] == FLT_MAX)
+		return;
+
+	// walk down the costs, every step goes to the neighbour the cheapest path continues to
+	path.push_back(m_StartNodeId);
+	for (int nodeId = m_StartNodeId; nodeId != m_GoalNodeId && static_cast<int>(path.size()) <= m_pGraph->GetAmountOfNodes();)
+	{
+		int nextNodeId = invalid_node_id;
+		float nextCost = FLT_MAX;
+		for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(nodeId))
+		{
+			const float toNodeCost = m_Costs[pConnection->GetToNodeId()];
+			if (toNodeCost != FLT_MAX && pConnection->GetCost() + toNodeCost < nextCost)
+			{
+				nextCost = pConnection->GetCost() + toNodeCost;
+				nextNodeId = pConnection->GetToNodeId();
+			}
+		}
+
+		if (nextNodeId == invalid_node_id)
+		{
+			path.clear();
+			return;
+		}
+		nodeId = nextNodeId;
+		path.push_back(nodeId);
+	}
+}
+
+void DStarLite::ApplyGraphChanges()
+{
+	if (m_Version == m_pGraph->GetVersion())
+		return;
+
+	m_Changes.clear();
+	bool isRepairable = m_pGraph->GetChangesSince(m_Version, m_Changes);
+	for (const GraphChange& change : m_Changes)
+	{
+		// new nodes don't fit the arrays and moved nodes change the heuristic, both need a new search
+		if (change.type == GraphChangeType::NodeAdded || change.type == GraphChangeType::NodeMoved)
+			isRepairable = false;
+	}
+
+	if (!isRepairable)
+	{
+		Initialize(m_StartNodeId, m_GoalNodeId);
+		return;
+	}
+
+	m_Version = m_pGraph->GetVersion();
+	// the lookahead of a node only depends on the connections leaving it (a removed node has none)
+	for (const GraphChange& change : m_Changes)
+		UpdateNode(change.fromNodeId);
+}
+
+void DStarLite::ComputeShortestPath()
+{
+	// also takes the nodes with the same key as the start, so every node the path can go through is settled
+	while (!m_OpenNodes.IsEmpty()
+		&& (m_OpenNodes.GetTopPriority() <= GetKey(m_StartNodeId) || m_LookaheadCosts[m_StartNodeId] != m_Costs[m_StartNodeId]))
+	{
+		const int currentNodeId = m_OpenNodes.GetTop();
+		const float oldKey = m_OpenNodes.GetTopPriority();
+		const float newKey = GetKey(currentNodeId);
+		++m_NrOfExpandedNodes;
+
+		if (oldKey < newKey)
+		{
+			// queued before the start moved
+			m_OpenNodes.Push(currentNodeId, newKey);
+			continue;
+		}
+
+		m_OpenNodes.Pop();
+		if (m_Costs[currentNodeId] > m_LookaheadCosts[currentNodeId])
+		{
+			m_Costs[currentNodeId] = m_LookaheadCosts[currentNodeId];
+		}
+		else
+		{
+			// got more expensive, the node is opened again with its new lookahead
+			m_Costs[currentNodeId] = FLT_MAX;
+			UpdateNode(currentNodeId);
+		}
+
+		if (!m_pGraph->IsNodeValid(currentNodeId))
+			continue;
+		for (const GraphConnection* const pConnection : GetConnectionsInto(currentNodeId))
+			UpdateNode(m_pGraph->IsDirectional() ? pConnection->GetFromNodeId() : pConnection->GetToNodeId());
+	}
+}
+
+void DStarLite::UpdateNode(int nodeId)
+{
+	if (nodeId != m_GoalNodeId)
+	{
+		float lookaheadCost = FLT_MAX;
+		if (m_pGraph->IsNodeValid(nodeId))
+		{
+			for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(nodeId))
+			{
+				const float toNodeCost = m_Costs[pConnection->GetToNodeId()];
+				if (toNodeCost != FLT_MAX)
+					lookaheadCost = std::min(lookaheadCost, pConnection->GetCost() + toNodeCost);
+			}
+		}
+		m_LookaheadCosts[nodeId] = lookaheadCost;
+	}
+
+	if (m_Costs[nodeId] != m_LookaheadCosts[nodeId])
+		m_OpenNodes.Push(nodeId, GetKey(nodeId));
+	else
+		m_OpenNodes.Remove(nodeId);
+}
+
+float DStarLite::GetKey(int nodeId) const
+{
+	const float cost = std::min(m_Costs[nodeId], m_LookaheadCosts[nodeId]);
+	if (cost == FLT_MAX)
+		return FLT_MAX;
+	return cost + GetHeuristicCost(m_StartNodeId, nodeId) + m_KeyModifier;
+}
+
+float DStarLite::GetHeuristicCost(int fromNodeId, int toNodeId) const
+{
+	Vector2 toNode = m_pGraph->GetNodePos(toNodeId) - m_pGraph->GetNodePos(fromNodeId);
+	return m_HeuristicFunction(abs(toNode.x), abs(toNode.y));
+}
+
+// The connections of an undirected graph lead both ways, directed graphs need the incoming ones
+const std::vector<GraphConnection*>& DStarLite::GetConnectionsInto(int nodeId) const
+{
+	return m_pGraph->IsDirectional() ? m_pGraph->GetConnectionsToNode(nodeId) : m_pGraph->GetConnectionsFromNode(nodeId);
+}
@@ -0,0 +1,63 @@
+//*=================================================*/
+// EDStarLite.h: Incremental planner (D* Lite) that keeps its search between calls. The search runs from the goal
+// towards the start, so the start can move along the path and edits of the graph only reopen the nodes whose cost to
+// the goal changed. The edits are read from the change journal of the graph, nothing has to be reported to the planner.
+// Added or moved nodes and a journal that lost changes start the search over.
+//*=================================================*/
+
+#pragma once
+#include "EAStar.h"
+
+namespace Elite
+{
+	class DStarLite final
+	{
+	public:
+		// The search runs backwards, so a directed Graph gets its incoming connections tracked and keeps them after the
+		// planner is gone (more memory per node, more work per edit). Undirected graphs are not changed
+		DStarLite(Graph* const pGraph, Heuristic hFunction);
+
+		// Forgets the previous search
+		void Initialize(int startNodeId, int goalNodeId);
+		bool IsInitialized() const { return m_GoalNodeId != invalid_node_id; }
+		int GetStartNodeId() const { return m_StartNodeId; }
+		int GetGoalNodeId() const { return m_GoalNodeId; }
+		// The agent moved on, the search stays valid for the same goal
+		void SetStart(int startNodeId);
+		// A different heuristic starts the search over
+		void SetHeuristicFunction(Heuristic hFunction);
+
+		// Repairs the search for the edits since the last call, the path is empty when the goal can't be reached
+		void FindPath(std::vector<GraphNode*>& path);
+		void FindPathIds(std::vector<int>& path);
+
+		// Nodes taken from the open list by the last FindPath
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		void ApplyGraphChanges();
+		void ComputeShortestPath();
+		void UpdateNode(int nodeId);
+		float GetKey(int nodeId) const;
+		float GetHeuristicCost(int fromNodeId, int toNodeId) const;
+		const std::vector<GraphConnection*>& GetConnectionsInto(int nodeId) const;
+
+		Graph* m_pGraph;
+		Heuristic m_HeuristicFunction;
+
+		int m_StartNodeId{ invalid_node_id };
+		int m_GoalNodeId{ invalid_node_id };
+		// start the keys were computed for, moving the start lowers all heuristics by at most the distance moved
+		int m_LastStartNodeId{ invalid_node_id };
+		float m_KeyModifier{ 0.f };
+		unsigned long long m_Version{ 0 };
+
+		// cost to the goal (g) and the one step lookahead of it (rhs), a node is queued while they differ
+		std::vector<float> m_Costs{};
+		std::vector<float> m_LookaheadCosts{};
+		IndexedPriorityQueue m_OpenNodes{};
+		std::vector<GraphChange> m_Changes{};
+		int m_NrOfExpandedNodes{ 0 };
+		std::vector<int> m_PathIds{};
+	};
+}
@@ -1,11 +1,9 @@
 #pragma once
-#include <stack>
 #include "../EliteGraph/EGraph.h"
 #include "../EliteGraph/EGraphConnection.h"
 #include "../EliteGraph/EGraphNode.h"
+#include "../EliteGraph/ECompactGraph.h"
 #include <algorithm>
-#include <execution>
-#include <ranges>
 
 namespace Elite
 {
@@ -16,196 +14,270 @@ namespace Elite
 		eulerian,
 	};
 
+	// Hierholzer's algorithm in O(V + E). The graph is only read: every node keeps a cursor to its first connection
+	// that might still be unused and used connections are marked in a bitset, an undirected connection together with its opposite
 	class EulerianPath final
 	{
 	public:
 		EulerianPath(Graph* const pGraph);
+		EulerianPath(const CompactGraph* const pGraph);
 
 		Eulerianity IsEulerian() const;
 		std::vector<GraphNode*> FindPath(Eulerianity& eulerianity) const;
 
 	private:
-		void VisitAllNodesDFS(const std::vector<GraphNode*>& pNodes, std::vector<bool>& visited, int startIndex) const;
-		bool IsConnected() const;
-
-		Graph* m_pGraph;
+		// The connections of all nodes as one range of indices, [firstConnections[nodeId], firstConnections[nodeId + 1]) per node
+		struct Adjacency
+		{
+			std::vector<int> firstConnections{};
+			std::vector<int> targets{};
+			std::vector<int> opposites{}; // undirected graphs only, the index of the same connection in the other direction
+		};
+
+		Adjacency BuildAdjacency() const;
+		void PairOppositeConnections(Adjacency& adjacency) const;
+		Eulerianity GetEulerianity(const Adjacency& adjacency) const;
+		bool IsConnected(const Adjacency& adjacency) const;
+
+		int GetNrOfNodeSlots() const { return m_pCompactGraph != nullptr ? m_pCompactGraph->GetNrOfNodeSlots() : m_pGraph->GetNrOfNodeSlots(); }
+		int GetAmountOfNodes() const { return m_pCompactGraph != nullptr ? m_pCompactGraph->GetAmountOfNodes() : m_pGraph->GetAmountOfNodes(); }
+		bool IsNodeValid(int nodeId) const { return m_pCompactGraph != nullptr ? m_pCompactGraph->IsNodeValid(nodeId) : m_pGraph->IsNodeValid(nodeId); }
+		bool IsDirectional() const { return m_pCompactGraph != nullptr ? m_pCompactGraph->IsDirectional() : m_pGraph->IsDirectional(); }
+		GraphNode* GetNode(int nodeId) const { return m_pCompactGraph != nullptr ? m_pCompactGraph->GetNode(nodeId) : m_pGraph->GetNode(nodeId); }
+
+		Graph* m_pGraph = nullptr;
+		const CompactGraph* m_pCompactGraph = nullptr;
 	};
 
 	inline EulerianPath::EulerianPath(Graph* const pGraph)
 		: m_pGraph(pGraph)
 	{
-		
 	}
 
-	inline Eulerianity EulerianPath::IsEulerian() const
+	inline EulerianPath::EulerianPath(const CompactGraph* const pGraph)
+		: m_pCompactGraph(pGraph)
 	{
-		// If the graph is not connected, there can be no Eulerian Trail
-
+	}
 
-		// Count nodes with odd degree 
+	inline Eulerianity EulerianPath::IsEulerian() const
+	{
+		return GetEulerianity(BuildAdjacency());
+	}
 
+	inline std::vector<GraphNode*> EulerianPath::FindPath(Eulerianity& eulerianity) const
+	{
+		auto path = std::vector<GraphNode*>();
 
-		// A connected graph with more than 2 nodes with an odd degree (an odd amount of connections) is not Eulerian
+		const Adjacency adjacency = BuildAdjacency();
+		eulerianity = GetEulerianity(adjacency);
+		if (eulerianity == Eulerianity::notEulerian)
+			return path;
 
+		// A semi-Eulerian trail has to start in one of the odd nodes, an Eulerian circuit can start anywhere
+		const int nrOfNodeSlots = GetNrOfNodeSlots();
+		int index{ invalid_node_id };
+		for (int nodeId = 0; nodeId < nrOfNodeSlots; ++nodeId)
+		{
+			if (!IsNodeValid(nodeId))
+				continue;
 
-		// A connected graph with exactly 2 nodes with an odd degree is Semi-Eulerian
-		// An Euler trail can be made, but only starting and ending in these 2 nodes
+			const int degree = adjacency.firstConnections[nodeId + 1] - adjacency.firstConnections[nodeId];
+			if (index == invalid_node_id || (degree & 1))
+				index = nodeId;
 
+			if (eulerianity != Eulerianity::semiEulerian || (degree & 1))
+				break;
+		}
 
-		// A connected graph with no odd nodes is Eulerian
+		std::vector<bool> isUsed(adjacency.targets.size(), false);
+		std::vector<int> nextConnections(adjacency.firstConnections.begin(), adjacency.firstConnections.end() - 1);
+		const bool hasOpposites = !adjacency.opposites.empty();
 
-		if (!IsConnected())
+		// Follow unused connections until stuck, the node where that happens is the next one of the path from the end
+		std::vector<int> nodeStack{ index };
+		while (!nodeStack.empty())
 		{
-			return Eulerianity::notEulerian;
-		}
+			const int nodeId = nodeStack.back();
+			const int connectionsEnd = adjacency.firstConnections[nodeId + 1];
+			int& connectionIdx = nextConnections[nodeId];
+			while (connectionIdx < connectionsEnd && isUsed[connectionIdx])
+				++connectionIdx;
 
-		auto& nodes = m_pGraph->GetAllNodes();
-		int oddcount = 0;
-		for (const auto& node : nodes)
-		{
-			auto& connections = m_pGraph->GetConnectionsFromNode(node->GetId());
-			if (connections.size() & 1)
+			if (connectionIdx == connectionsEnd)
 			{
-				++oddcount;
+				path.emplace_back(GetNode(nodeId));
+				nodeStack.pop_back();
+				continue;
 			}
-		}
 
-		if (oddcount > 2)
-		{
-			return Eulerianity::notEulerian;
+			isUsed[connectionIdx] = true;
+			if (hasOpposites && adjacency.opposites[connectionIdx] != -1)
+				isUsed[adjacency.opposites[connectionIdx]] = true;
+			nodeStack.push_back(adjacency.targets[connectionIdx]);
 		}
 
-		else if (oddcount == 2 && nodes.size() != 2)
-		{
-			return Eulerianity::semiEulerian;
-		}
-
-		return Eulerianity::eulerian;
-
+		std::reverse(path.begin(), path.end());
+		return path;
 	}
 
-	inline std::vector<GraphNode*> EulerianPath::FindPath(Eulerianity& eulerianity) const
+	inline EulerianPath::Adjacency EulerianPath::BuildAdjacency() const
 	{
-		// Get a copy of the graph because this algorithm involves removing edges
-		auto graphCopy = m_pGraph->Clone();
-		auto path = std::vector<GraphNode*>();
-		int nrOfNodes = graphCopy->GetAmountOfNodes();
-
-		// Check if there can be an Euler path
-		eulerianity = IsEulerian();
+		Adjacency adjacency{};
+		const int nrOfNodeSlots = GetNrOfNodeSlots();
+		adjacency.firstConnections.assign(nrOfNodeSlots + 1, 0);
 
-		int index{ -1 };
-		// Find a valid starting id for the algorithm
-		
-		// If this graph is not eulerian, return the empty path
-		switch (eulerianity)
+		if (m_pCompactGraph != nullptr)
 		{
-		case Eulerianity::notEulerian:
-			return path;
-			break;
-		case Eulerianity::semiEulerian:
-			index = 0;
-			break;
-		case Eulerianity::eulerian:
-			while (index < 0)
+			for (int nodeId = 0; nodeId < nrOfNodeSlots; ++nodeId)
 			{
-				int randomIdx = Elite::RandomInt(nrOfNodes);
-				if (graphCopy->GetNode(randomIdx))
-				{
-					index = randomIdx;
-					break;
-				}
+				adjacency.firstConnections[nodeId] = static_cast<int>(adjacency.targets.size());
+				if (!m_pCompactGraph->IsNodeValid(nodeId))
+					continue;
+
+				for (int connectionIdx = m_pCompactGraph->GetConnectionsBegin(nodeId); connectionIdx < m_pCompactGraph->GetConnectionsEnd(nodeId); ++connectionIdx)
+					adjacency.targets.push_back(m_pCompactGraph->GetConnectionTarget(connectionIdx));
 			}
-			break;
 		}
-		
-		// Start algorithm loop
-		std::stack<int> nodeStack;
-		
-		while (!(nodeStack.empty() && (graphCopy->GetConnectionsFromNode(index).empty())))
+		else
 		{
-			if (!graphCopy->GetConnectionsFromNode(index).empty())
+			adjacency.targets.reserve(m_pGraph->GetAmountOfConnections());
+			for (int nodeId = 0; nodeId < nrOfNodeSlots; ++nodeId)
 			{
-				nodeStack.push(index);
+				adjacency.firstConnections[nodeId] = static_cast<int>(adjacency.targets.size());
+				if (!m_pGraph->IsNodeValid(nodeId))
+					continue;
 
-				auto connections = graphCopy->GetConnectionsFromNode(index);
-				int randomConnectionIndex = Elite::RandomInt(connections.size());
-				int selectedNeighbor = connections[randomConnectionIndex]->GetToNodeId();
-				graphCopy->RemoveConnection(connections[randomConnectionIndex]);
-				index = selectedNeighbor;
-			}
-			else
-			{
-				path.emplace_back(m_pGraph->GetNode(index));
-				index = nodeStack.top();
-				nodeStack.pop();
+				for (const GraphConnection* const pConnection : m_pGraph->GetConnectionsFromNode(nodeId))
+					adjacency.targets.push_back(pConnection->GetToNodeId());
 			}
-
 		}
+		adjacency.firstConnections[nrOfNodeSlots] = static_cast<int>(adjacency.targets.size());
 
-		path.emplace_back(m_pGraph->GetNode(index));
-
-		std::reverse(path.begin(), path.end()); // reverses order of the path
-		return path;
+		if (!IsDirectional())
+			PairOppositeConnections(adjacency);
+		return adjacency;
 	}
 
-	inline void EulerianPath::VisitAllNodesDFS(const std::vector<GraphNode*>& pNodes, std::vector<bool>& visited, int startIndex ) const
+	// Undirected connections are stored in both directions. Going through the nodes in order, a connection to a higher node
+	// waits in a list of that node, and the connections back from that node take the waiting ones of the lower node
+	inline void EulerianPath::PairOppositeConnections(Adjacency& adjacency) const
 	{
-		// mark the visited node
-		
-		// Ask the graph for the connections from that node
-		
-		// recursively visit any connected nodes that were not visited before
-
-		// Tip: use an index-based for-loop to find the correct index
-
-		visited[startIndex] = true;
+		const int nrOfNodeSlots = GetNrOfNodeSlots();
+		const int nrOfConnections = static_cast<int>(adjacency.targets.size());
+		adjacency.opposites.assign(nrOfConnections, -1);
 
-		auto connections = m_pGraph->GetConnectionsFromNode(pNodes[startIndex]);
+		std::vector<int> sources(nrOfConnections, invalid_node_id);
+		std::vector<int> waitingHeads(nrOfNodeSlots, -1); // per node, the connections into it from lower nodes
+		std::vector<int> nextWaiting(nrOfConnections, -1);
+		std::vector<int> fromLowerHeads(nrOfNodeSlots, -1); // per lower node, its waiting connections into the current node
+		std::vector<int> nextFromLower(nrOfConnections, -1);
 
-		for (GraphConnection* connection : connections) // Range-based loop for readability
+		for (int nodeId = 0; nodeId < nrOfNodeSlots; ++nodeId)
 		{
-			int neighborIndex = connection->GetToNodeId(); // Get the ID of the connected node
+			for (int waitingIdx = waitingHeads[nodeId]; waitingIdx != -1; waitingIdx = nextWaiting[waitingIdx])
+			{
+				nextFromLower[waitingIdx] = fromLowerHeads[sources[waitingIdx]];
+				fromLowerHeads[sources[waitingIdx]] = waitingIdx;
+			}
 
-			// Ensure the neighborIndex is within valid bounds before accessing visited
-			if (neighborIndex >= 0 && neighborIndex < visited.size() && !visited[neighborIndex])
+			int selfLoopIdx = -1;
+			for (int connectionIdx = adjacency.firstConnections[nodeId]; connectionIdx < adjacency.firstConnections[nodeId + 1]; ++connectionIdx)
 			{
-				VisitAllNodesDFS(pNodes, visited, neighborIndex);
+				const int toNodeId = adjacency.targets[connectionIdx];
+				if (toNodeId > nodeId)
+				{
+					sources[connectionIdx] = nodeId;
+					nextWaiting[connectionIdx] = waitingHeads[toNodeId];
+					waitingHeads[toNodeId] = connectionIdx;
+				}
+				else if (toNodeId < nodeId)
+				{
+					const int oppositeIdx = fromLowerHeads[toNodeId];
+					if (oppositeIdx == -1)
+						continue;
+
+					fromLowerHeads[toNodeId] = nextFromLower[oppositeIdx];
+					adjacency.opposites[connectionIdx] = oppositeIdx;
+					adjacency.opposites[oppositeIdx] = connectionIdx;
+				}
+				else if (selfLoopIdx == -1)
+				{
+					selfLoopIdx = connectionIdx;
+				}
+				else
+				{
+					// a loop is stored twice in the same node
+					adjacency.opposites[connectionIdx] = selfLoopIdx;
+					adjacency.opposites[selfLoopIdx] = connectionIdx;
+					selfLoopIdx = -1;
+				}
 			}
+
+			for (int waitingIdx = waitingHeads[nodeId]; waitingIdx != -1; waitingIdx = nextWaiting[waitingIdx])
+				fromLowerHeads[sources[waitingIdx]] = -1;
+		}
+	}
+
+	inline Eulerianity EulerianPath::GetEulerianity(const Adjacency& adjacency) const
+	{
+		// If the graph is not connected, there can be no Eulerian Trail
+		if (!IsConnected(adjacency))
+			return Eulerianity::notEulerian;
+
+		// Count nodes with odd degree
+		int oddCount = 0;
+		for (int nodeId = 0; nodeId < GetNrOfNodeSlots(); ++nodeId)
+		{
+			if ((adjacency.firstConnections[nodeId + 1] - adjacency.firstConnections[nodeId]) & 1)
+				++oddCount;
 		}
 
+		// A connected graph with more than 2 nodes with an odd degree (an odd amount of connections) is not Eulerian
+		if (oddCount > 2)
+			return Eulerianity::notEulerian;
+
+		// A connected graph with exactly 2 nodes with an odd degree is Semi-Eulerian
+		// An Euler trail can be made, but only starting and ending in these 2 nodes
+		else if (oddCount == 2 && GetAmountOfNodes() != 2)
+			return Eulerianity::semiEulerian;
+
+		// A connected graph with no odd nodes is Eulerian
+		return Eulerianity::eulerian;
 	}
 
-	inline bool EulerianPath::IsConnected() const
+	inline bool EulerianPath::IsConnected(const Adjacency& adjacency) const
 	{
-		auto nodes = m_pGraph->GetAllNodes();
-		if (nodes.size() == 0)
+		if (GetAmountOfNodes() == 0)
 			return false;
 
-		// pick a starting node index
-		
-		int index{ -1 };
-		while (index < 0)
+		int startIndex{ 0 };
+		while (!IsNodeValid(startIndex))
+			++startIndex;
+
+		// iterative depth first search, so big graphs can't overflow the call stack
+		std::vector<bool> visited(GetNrOfNodeSlots(), false);
+		std::vector<int> nodeStack{ startIndex };
+		visited[startIndex] = true;
+		int nrOfVisitedNodes{ 1 };
+
+		while (!nodeStack.empty())
 		{
-			int randomIdx = Elite::RandomInt(nodes.size());
-			if (m_pGraph->GetNode(randomIdx))
+			const int nodeId = nodeStack.back();
+			nodeStack.pop_back();
+
+			for (int connectionIdx = adjacency.firstConnections[nodeId]; connectionIdx < adjacency.firstConnections[nodeId + 1]; ++connectionIdx)
 			{
-				index = randomIdx;
-				break;
+				const int neighborId = adjacency.targets[connectionIdx];
+				if (!visited[neighborId])
+				{
+					visited[neighborId] = true;
+					++nrOfVisitedNodes;
+					nodeStack.push_back(neighborId);
+				}
 			}
 		}
-		
-		//std::vector<GraphNode*> nodes = m_pGraph->GetAllNodes();
-		std::vector<bool> visited;
-		visited.resize(nodes.size(), false);
-
-		VisitAllNodesDFS(nodes, visited, index);
 
-		if (std::any_of(visited.begin(), visited.end(), [](bool v) { return !v; })) {
-			return false;
-		}
-		return true;
 		// if a node was never visited, this graph is not connected
-
+		return nrOfVisitedNodes == GetAmountOfNodes();
 	}
-}
\ No newline at end of file
+}
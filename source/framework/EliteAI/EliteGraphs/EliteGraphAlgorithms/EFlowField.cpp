@@ -0,0 +1,71 @@
+#include "stdafx.h"
+#include "EFlowField.h"
+
+#include "../EliteGraph/EGraphConnection.h"
+
+using namespace Elite;
+
+FlowField::FlowField(GridGraph* const pGraph)
+	: m_pGraph(pGraph)
+{
+	if (m_pGraph->IsDirectional() && !m_pGraph->IsTrackingIncomingConnections())
+		m_pGraph->SetTrackIncomingConnections(true);
+}
+
+void FlowField::Build(int goalNodeId)
+{
+	Build(std::vector<int>{ goalNodeId });
+}
+
+void FlowField::Build(const std::vector<int>& goalNodeIds)
+{
+	const int nrOfNodeSlots = m_pGraph->GetNrOfNodeSlots();
+	m_Costs.assign(nrOfNodeSlots, FLT_MAX);
+	m_NextNodeIds.assign(nrOfNodeSlots, invalid_node_id);
+	m_Directions.assign(nrOfNodeSlots, Vector2{});
+	if (m_OpenNodes.GetNrOfIds() < nrOfNodeSlots)
+		m_OpenNodes.Resize(nrOfNodeSlots);
+	m_OpenNodes.Clear();
+
+	m_IsBuilt = true;
+	m_Version = m_pGraph->GetVersion();
+
+	for (int goalNodeId : goalNodeIds)
+	{
+		if (!m_pGraph->IsNodeValid(goalNodeId))
+			continue;
+
+		m_Costs[goalNodeId] = 0.f;
+		m_OpenNodes.Push(goalNodeId, 0.f);
+	}
+
+	// Dijkstra over the connections into every cell, so a cell ends up with the cost of its cheapest path to a goal
+	const bool isDirectional = m_pGraph->IsDirectional();
+	while (!m_OpenNodes.IsEmpty())
+	{
+		const int currentNodeId = m_OpenNodes.Pop();
+		const float currentCost = m_Costs[currentNodeId];
+
+		const std::vector<GraphConnection*>& connections = isDirectional ? m_pGraph->GetConnectionsToNode(currentNodeId) : m_pGraph->GetConnectionsFromNode(currentNodeId);
+		for (const GraphConnection* const pConnection : connections)
+		{
+			const int previousNodeId = isDirectional ? pConnection->GetFromNodeId() : pConnection->GetToNodeId();
+			const float cost = currentCost + pConnection->GetCost();
+			if (cost >= m_Costs[previousNodeId])
+				continue;
+
+			m_Costs[previousNodeId] = cost;
+			m_NextNodeIds[previousNodeId] = currentNodeId;
+			m_OpenNodes.Push(previousNodeId, cost);
+		}
+	}
+
+	for (int nodeId = 0; nodeId < nrOfNodeSlots; ++nodeId)
+	{
+		if (m_NextNodeIds[nodeId] == invalid_node_id)
+			continue;
+
+		m_Directions[nodeId] = m_pGraph->GetNodePos(m_NextNodeIds[nodeId]) - m_pGraph->GetNodePos(nodeId);
+		m_Directions[nodeId].Normalize();
+	}
+}
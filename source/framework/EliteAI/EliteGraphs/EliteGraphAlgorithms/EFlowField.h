@@ -0,0 +1,51 @@
+//*=================================================*/
+// EFlowField.h: Integration and flow field over a grid, for many agents that go to the same goal.
+// One Dijkstra from the goal cells gives the cost to the goal of every cell (the integration field),
+// every cell then points to the neighbour its cheapest path continues to (the flow field).
+// Agents only have to look up their cell, so the cost is one search per goal instead of one per agent.
+//*=================================================*/
+
+#pragma once
+#include "../EliteGridGraph/EGridGraph.h"
+#include "EIndexedPriorityQueue.h"
+
+namespace Elite
+{
+	class FlowField final
+	{
+	public:
+		// The search follows the connections backwards from the goal, so a directed grid gets its incoming connections
+		// tracked and keeps them after the field is gone. Undirected grids are not changed
+		explicit FlowField(GridGraph* const pGraph);
+
+		// Several goal cells flow to whichever one is cheapest to reach
+		void Build(int goalNodeId);
+		void Build(const std::vector<int>& goalNodeIds);
+		// Build was called for the current version of the graph
+		bool IsUpToDate() const { return m_IsBuilt && m_Version == m_pGraph->GetVersion(); }
+
+		const GridGraph* GetGraph() const { return m_pGraph; }
+		int GetNodeIdAtPosition(const Vector2& position) const { return m_pGraph->GetNodeIdAtPosition(position); }
+
+		// Cost to the nearest goal, FLT_MAX for cells that can't reach one
+		float GetCost(int nodeId) const { return IsInField(nodeId) ? m_Costs[nodeId] : FLT_MAX; }
+		bool IsGoal(int nodeId) const { return GetCost(nodeId) == 0.f && m_NextNodeIds[nodeId] == invalid_node_id; }
+		// Next cell on the cheapest path, invalid_node_id on goals and cells that can't reach one
+		int GetNextNodeId(int nodeId) const { return IsInField(nodeId) ? m_NextNodeIds[nodeId] : invalid_node_id; }
+		// Unit vector to the next cell, zero on goals and cells that can't reach one
+		Vector2 GetDirection(int nodeId) const { return IsInField(nodeId) ? m_Directions[nodeId] : Vector2{}; }
+		Vector2 GetDirection(const Vector2& position) const { return GetDirection(GetNodeIdAtPosition(position)); }
+
+	private:
+		bool IsInField(int nodeId) const { return nodeId >= 0 && nodeId < static_cast<int>(m_Costs.size()); }
+
+		GridGraph* m_pGraph;
+		bool m_IsBuilt{ false };
+		unsigned long long m_Version{ 0 };
+
+		std::vector<float> m_Costs{};
+		std::vector<int> m_NextNodeIds{};
+		std::vector<Vector2> m_Directions{};
+		IndexedPriorityQueue m_OpenNodes{};
+	};
+}
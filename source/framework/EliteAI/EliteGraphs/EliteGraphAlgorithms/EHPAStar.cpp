@@ -0,0 +1,547 @@
+#include "stdafx.h"
+#include "EHPAStar.h"
+
+using namespace Elite;
+
+HPAStar::HPAStar(GridGraph* const pGrid, int clusterSize, Heuristic hFunction)
+	: m_pGrid(pGrid)
+	, m_ClusterSize(clusterSize)
+	, m_NrOfClusterColumns((pGrid->GetColumns() + clusterSize - 1) / clusterSize)
+	, m_NrOfClusterRows((pGrid->GetRows() + clusterSize - 1) / clusterSize)
+	, m_HeuristicFunction(hFunction)
+{
+	assert(clusterSize > 0 && "HPAStar: clusters need at least one cell");
+
+	// backward searches from the destination follow the connections into a cell
+	if (m_pGrid->IsDirectional() && !m_pGrid->IsTrackingIncomingConnections())
+		m_pGrid->SetTrackIncomingConnections(true);
+	m_AbstractGraph.SetTrackIncomingConnections(true);
+
+	m_IsClusterMarked.assign(GetNrOfClusters(), 0);
+	m_IsBorderMarked.assign(GetNrOfClusters() * NrOfBorders, 0);
+
+	Update();
+}
+
+std::vector<GraphNode*> HPAStar::FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode)
+{
+	FindPathIds(pStartNode->GetId(), pDestinationNode->GetId(), m_PathIds);
+
+	std::vector<GraphNode*> path{};
+	path.reserve(m_PathIds.size());
+	for (int nodeId : m_PathIds)
+		path.push_back(m_pGrid->GetNode(nodeId));
+	return path;
+}
+
+std::vector<int> HPAStar::FindPathIds(int startNodeId, int destinationNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, destinationNodeId, path);
+	return path;
+}
+
+void HPAStar::FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path)
+{
+	path.clear();
+	if (!FindAbstractPath(startNodeId, destinationNodeId, m_Waypoints))
+		return;
+
+	if (m_Waypoints.size() == 1)
+	{
+		path.push_back(startNodeId);
+		return;
+	}
+
+	for (size_t waypointIdx = 1; waypointIdx < m_Waypoints.size(); ++waypointIdx)
+	{
+		if (!RefinePathSegment(m_Waypoints[waypointIdx - 1], m_Waypoints[waypointIdx], path))
+		{
+			path.clear();
+			return;
+		}
+	}
+}
+
+bool HPAStar::FindAbstractPath(int startNodeId, int destinationNodeId, std::vector<int>& waypoints)
+{
+	waypoints.clear();
+	Update();
+
+	if (!m_pGrid->IsNodeValid(startNodeId) || !m_pGrid->IsNodeValid(destinationNodeId))
+		return false;
+
+	if (startNodeId == destinationNodeId)
+	{
+		waypoints.push_back(startNodeId);
+		return true;
+	}
+
+	const int startClusterIdx = GetClusterIdx(startNodeId);
+	const int destinationClusterIdx = GetClusterIdx(destinationNodeId);
+
+	// inside one cluster the local path is used when there is one, else the path has to go around through other clusters
+	SearchCluster(startNodeId, false);
+	if (startClusterIdx == destinationClusterIdx && m_ClusterSearchContext.IsReached(destinationNodeId))
+	{
+		waypoints.push_back(startNodeId);
+		waypoints.push_back(destinationNodeId);
+		return true;
+	}
+
+	// start and destination are connected to the entrances of their cluster they can reach, without touching the abstract graph
+	GraphOverlay overlay{ &m_AbstractGraph };
+	const int startId = overlay.AddNode(new GraphNode(m_pGrid->GetNodePos(startNodeId)));
+	const int destinationId = overlay.AddNode(new GraphNode(m_pGrid->GetNodePos(destinationNodeId)));
+
+	GetEntrances(startClusterIdx, m_Entrances);
+	for (int nodeId : m_Entrances)
+	{
+		if (m_ClusterSearchContext.IsReached(nodeId))
+			overlay.AddConnection(startId, m_AbstractNodeIds[nodeId], m_ClusterSearchContext.GetCostSoFar(nodeId));
+	}
+
+	SearchCluster(destinationNodeId, true);
+	GetEntrances(destinationClusterIdx, m_Entrances);
+	for (int nodeId : m_Entrances)
+	{
+		if (m_ClusterSearchContext.IsReached(nodeId))
+			overlay.AddConnection(m_AbstractNodeIds[nodeId], destinationId, m_ClusterSearchContext.GetCostSoFar(nodeId));
+	}
+
+	AStar abstractSearch{ &overlay, m_HeuristicFunction };
+	abstractSearch.FindPathIds(startId, destinationId, m_AbstractPath);
+	if (m_AbstractPath.empty())
+	{
+		// entrances only sit on a few cells of every border, let a search on the grid decide if there really is no path
+		waypoints.push_back(startNodeId);
+		waypoints.push_back(destinationNodeId);
+		return true;
+	}
+
+	for (int abstractId : m_AbstractPath)
+	{
+		int nodeId = invalid_node_id;
+		if (abstractId == startId)
+			nodeId = startNodeId;
+		else if (abstractId == destinationId)
+			nodeId = destinationNodeId;
+		else
+			nodeId = m_EntranceNodeIds[abstractId];
+
+		if (waypoints.empty() || waypoints.back() != nodeId)
+			waypoints.push_back(nodeId);
+	}
+	return true;
+}
+
+bool HPAStar::RefinePathSegment(int fromNodeId, int toNodeId, std::vector<int>& path)
+{
+	AStar segmentSearch{ m_pGrid, m_HeuristicFunction };
+	segmentSearch.FindPathIds(fromNodeId, toNodeId, m_Segment);
+	if (m_Segment.empty())
+		return false;
+
+	const size_t firstIdx = !path.empty() && path.back() == m_Segment.front() ? 1 : 0;
+	path.insert(path.end(), m_Segment.begin() + firstIdx, m_Segment.end());
+	return true;
+}
+
+void HPAStar::Update()
+{
+	m_NrOfRebuiltClusters = 0;
+
+	m_Changes.clear();
+	const bool hasChanges = m_IsBuilt && m_pGrid->GetChangesSince(m_GraphVersion, m_Changes);
+	m_GraphVersion = m_pGrid->GetVersion();
+
+	// the journal no longer goes back far enough (or there is nothing built yet)
+	if (!hasChanges)
+	{
+		BuildAll();
+		return;
+	}
+
+	const int nrOfCells = m_pGrid->GetRows() * m_pGrid->GetColumns();
+	m_ChangedClusters.clear();
+	for (const GraphChange& change : m_Changes)
+	{
+		for (int nodeId : { change.fromNodeId, change.toNodeId })
+		{
+			if (nodeId < 0 || nodeId >= nrOfCells)
+				continue;
+
+			const int clusterIdx = GetClusterIdx(nodeId);
+			if (m_IsClusterMarked[clusterIdx] == 0)
+			{
+				m_IsClusterMarked[clusterIdx] = 1;
+				m_ChangedClusters.push_back(clusterIdx);
+			}
+		}
+	}
+	for (int clusterIdx : m_ChangedClusters)
+		m_IsClusterMarked[clusterIdx] = 0;
+
+	if (!m_ChangedClusters.empty())
+		RebuildClusters(m_ChangedClusters);
+}
+
+void HPAStar::BuildAll()
+{
+	m_AbstractGraph.Clear();
+
+	const int nrOfCells = m_pGrid->GetRows() * m_pGrid->GetColumns();
+	m_AbstractNodeIds.assign(nrOfCells, invalid_node_id);
+	m_NrOfTransitions.assign(nrOfCells, 0);
+	m_EntranceNodeIds.clear();
+	m_Transitions.assign(GetNrOfClusters() * NrOfBorders, {});
+
+	for (int clusterIdx = 0; clusterIdx < GetNrOfClusters(); ++clusterIdx)
+	{
+		for (int border = 0; border < NrOfBorders; ++border)
+		{
+			std::vector<Transition>& transitions = m_Transitions[clusterIdx * NrOfBorders + border];
+			FindTransitions(clusterIdx, static_cast<Border>(border), transitions);
+			for (const Transition& transition : transitions)
+				AddTransition(transition);
+		}
+	}
+
+	for (int clusterIdx = 0; clusterIdx < GetNrOfClusters(); ++clusterIdx)
+		ConnectEntrances(clusterIdx);
+
+	m_IsBuilt = true;
+}
+
+void HPAStar::RebuildClusters(const std::vector<int>& changedClusters)
+{
+	// a changed cluster gets new paths between its entrances, its neighbours only when the entrances on their shared border moved
+	m_ClustersToConnect.clear();
+	for (int clusterIdx : changedClusters)
+	{
+		m_IsClusterMarked[clusterIdx] = 1;
+		m_ClustersToConnect.push_back(clusterIdx);
+	}
+
+	m_MarkedBorders.clear();
+	for (int clusterIdx : changedClusters)
+	{
+		int borderKeys[2 * NrOfBorders]{};
+		const int nrOfBorders = GetBordersAround(clusterIdx, borderKeys);
+		for (int borderIdx = 0; borderIdx < nrOfBorders; ++borderIdx)
+		{
+			const int borderKey = borderKeys[borderIdx];
+			if (m_IsBorderMarked[borderKey] != 0)
+				continue;
+			m_IsBorderMarked[borderKey] = 1;
+			m_MarkedBorders.push_back(borderKey);
+
+			const int ownerIdx = borderKey / NrOfBorders;
+			const Border border = static_cast<Border>(borderKey % NrOfBorders);
+			std::vector<Transition>& transitions = m_Transitions[borderKey];
+			FindTransitions(ownerIdx, border, m_NewTransitions);
+
+			if (m_NewTransitions == transitions)
+			{
+				// same entrances, the costs to cross may still have changed
+				for (const Transition& transition : transitions)
+				{
+					RemoveCrossingConnections(transition);
+					AddCrossingConnections(transition);
+				}
+				continue;
+			}
+
+			// the old entrances are released after adding the new ones, so the entrances that stay keep their abstract node
+			for (const Transition& transition : transitions)
+				RemoveCrossingConnections(transition);
+			for (const Transition& transition : m_NewTransitions)
+				AddTransition(transition);
+			for (const Transition& transition : transitions)
+			{
+				RemoveEntrance(transition.insideNodeId);
+				RemoveEntrance(transition.outsideNodeId);
+			}
+			transitions = m_NewTransitions;
+
+			for (int neighborIdx : { ownerIdx, GetNeighborClusterIdx(ownerIdx, border) })
+			{
+				if (m_IsClusterMarked[neighborIdx] == 0)
+				{
+					m_IsClusterMarked[neighborIdx] = 1;
+					m_ClustersToConnect.push_back(neighborIdx);
+				}
+			}
+		}
+	}
+	for (int borderKey : m_MarkedBorders)
+		m_IsBorderMarked[borderKey] = 0;
+
+	for (int clusterIdx : m_ClustersToConnect)
+	{
+		m_IsClusterMarked[clusterIdx] = 0;
+		ConnectEntrances(clusterIdx);
+	}
+}
+
+void HPAStar::ConnectEntrances(int clusterIdx)
+{
+	GetEntrances(clusterIdx, m_Entrances);
+
+	// drop the old paths between the entrances of this cluster, the crossings to other clusters stay
+	for (int nodeId : m_Entrances)
+	{
+		const int abstractId = m_AbstractNodeIds[nodeId];
+		m_RemovedConnections.clear();
+		for (const GraphConnection* const pConnection : m_AbstractGraph.GetConnectionsFromNode(abstractId))
+		{
+			if (GetClusterIdx(m_EntranceNodeIds[pConnection->GetToNodeId()]) == clusterIdx)
+				m_RemovedConnections.push_back(pConnection->GetToNodeId());
+		}
+		for (int toAbstractId : m_RemovedConnections)
+			m_AbstractGraph.RemoveConnection(abstractId, toAbstractId);
+	}
+
+	for (int fromNodeId : m_Entrances)
+	{
+		SearchCluster(fromNodeId, false);
+		for (int toNodeId : m_Entrances)
+		{
+			if (toNodeId != fromNodeId && m_ClusterSearchContext.IsReached(toNodeId))
+				m_AbstractGraph.AddConnection(new GraphConnection(m_AbstractNodeIds[fromNodeId], m_AbstractNodeIds[toNodeId], m_ClusterSearchContext.GetCostSoFar(toNodeId)));
+		}
+	}
+
+	++m_NrOfRebuiltClusters;
+}
+
+void HPAStar::FindTransitions(int clusterIdx, Border border, std::vector<Transition>& transitions) const
+{
+	transitions.clear();
+	if (GetNeighborClusterIdx(clusterIdx, border) == invalid_node_id)
+		return;
+
+	int minCol{}, minRow{}, maxCol{}, maxRow{};
+	GetClusterBounds(clusterIdx, minCol, minRow, maxCol, maxRow);
+
+	// the corners only have a diagonal crossing
+	if (border == NorthEast || border == NorthWest)
+	{
+		const int insideNodeId = border == NorthEast ? m_pGrid->GetNodeId(maxCol, maxRow) : m_pGrid->GetNodeId(minCol, maxRow);
+		const int outsideNodeId = border == NorthEast ? m_pGrid->GetNodeId(maxCol + 1, maxRow + 1) : m_pGrid->GetNodeId(minCol - 1, maxRow + 1);
+		if (IsCrossing(insideNodeId, outsideNodeId))
+			transitions.push_back({ insideNodeId, outsideNodeId });
+		return;
+	}
+
+	// walk along the border, the east one over the rows and the north one over the columns
+	const bool isEast = border == East;
+	const int first = isEast ? minRow : minCol;
+	const int last = isEast ? maxRow : maxCol;
+	auto getInsideNodeId = [&](int idx) { return isEast ? m_pGrid->GetNodeId(maxCol, idx) : m_pGrid->GetNodeId(idx, maxRow); };
+	auto getOutsideNodeId = [&](int idx) { return isEast ? m_pGrid->GetNodeId(maxCol + 1, idx) : m_pGrid->GetNodeId(idx, maxRow + 1); };
+	auto isStraightCrossing = [&](int idx) { return IsCrossing(getInsideNodeId(idx), getOutsideNodeId(idx)); };
+
+	// every run of straight crossings becomes one entrance in its middle, long runs get one at both ends
+	int runStart = -1;
+	for (int idx = first; idx <= last + 1; ++idx)
+	{
+		if (idx <= last && isStraightCrossing(idx))
+		{
+			if (runStart < 0)
+				runStart = idx;
+			continue;
+		}
+		if (runStart < 0)
+			continue;
+
+		const int runEnd = idx - 1;
+		if (runEnd - runStart + 1 < LONG_ENTRANCE_LENGTH)
+		{
+			const int middle = (runStart + runEnd) / 2;
+			transitions.push_back({ getInsideNodeId(middle), getOutsideNodeId(middle) });
+		}
+		else
+		{
+			transitions.push_back({ getInsideNodeId(runStart), getOutsideNodeId(runStart) });
+			transitions.push_back({ getInsideNodeId(runEnd), getOutsideNodeId(runEnd) });
+		}
+		runStart = -1;
+	}
+
+	// diagonal crossings between cells that can't cross straight (e.g. squeezing past a corner), the ones past the ends belong to the corners
+	for (int idx = first; idx <= last; ++idx)
+	{
+		if (isStraightCrossing(idx))
+			continue;
+
+		for (int otherIdx : { idx - 1, idx + 1 })
+		{
+			if (otherIdx < first || otherIdx > last || isStraightCrossing(otherIdx))
+				continue;
+			if (IsCrossing(getInsideNodeId(idx), getOutsideNodeId(otherIdx)))
+				transitions.push_back({ getInsideNodeId(idx), getOutsideNodeId(otherIdx) });
+		}
+	}
+}
+
+void HPAStar::AddTransition(const Transition& transition)
+{
+	AddEntrance(transition.insideNodeId);
+	AddEntrance(transition.outsideNodeId);
+	AddCrossingConnections(transition);
+}
+
+void HPAStar::AddCrossingConnections(const Transition& transition)
+{
+	const int insideId = m_AbstractNodeIds[transition.insideNodeId];
+	const int outsideId = m_AbstractNodeIds[transition.outsideNodeId];
+
+	if (const GraphConnection* const pConnection = m_pGrid->GetConnection(transition.insideNodeId, transition.outsideNodeId))
+		m_AbstractGraph.AddConnection(new GraphConnection(insideId, outsideId, pConnection->GetCost()));
+	if (const GraphConnection* const pConnection = m_pGrid->GetConnection(transition.outsideNodeId, transition.insideNodeId))
+		m_AbstractGraph.AddConnection(new GraphConnection(outsideId, insideId, pConnection->GetCost()));
+}
+
+void HPAStar::RemoveCrossingConnections(const Transition& transition)
+{
+	const int insideId = m_AbstractNodeIds[transition.insideNodeId];
+	const int outsideId = m_AbstractNodeIds[transition.outsideNodeId];
+
+	if (m_AbstractGraph.ConnectionExists(insideId, outsideId))
+		m_AbstractGraph.RemoveConnection(insideId, outsideId);
+	if (m_AbstractGraph.ConnectionExists(outsideId, insideId))
+		m_AbstractGraph.RemoveConnection(outsideId, insideId);
+}
+
+void HPAStar::AddEntrance(int nodeId)
+{
+	if (m_NrOfTransitions[nodeId]++ == 0)
+	{
+		const int abstractId = m_AbstractGraph.AddNode(new GraphNode(m_pGrid->GetNodePos(nodeId)));
+		m_AbstractNodeIds[nodeId] = abstractId;
+		if (static_cast<int>(m_EntranceNodeIds.size()) <= abstractId)
+			m_EntranceNodeIds.resize(abstractId + 1, invalid_node_id);
+		m_EntranceNodeIds[abstractId] = nodeId;
+	}
+}
+
+void HPAStar::RemoveEntrance(int nodeId)
+{
+	assert(m_NrOfTransitions[nodeId] > 0 && "HPAStar: cell is no entrance");
+	if (--m_NrOfTransitions[nodeId] == 0)
+	{
+		const int abstractId = m_AbstractNodeIds[nodeId];
+		m_AbstractGraph.RemoveNode(abstractId);
+		m_EntranceNodeIds[abstractId] = invalid_node_id;
+		m_AbstractNodeIds[nodeId] = invalid_node_id;
+	}
+}
+
+void HPAStar::GetEntrances(int clusterIdx, std::vector<int>& entrances) const
+{
+	entrances.clear();
+
+	int borderKeys[2 * NrOfBorders]{};
+	const int nrOfBorders = GetBordersAround(clusterIdx, borderKeys);
+	for (int borderIdx = 0; borderIdx < nrOfBorders; ++borderIdx)
+	{
+		// on its own borders the cluster is on the inside, on the ones of its neighbours on the outside
+		const bool isOwner = borderKeys[borderIdx] / NrOfBorders == clusterIdx;
+		for (const Transition& transition : m_Transitions[borderKeys[borderIdx]])
+			entrances.push_back(isOwner ? transition.insideNodeId : transition.outsideNodeId);
+	}
+
+	std::sort(entrances.begin(), entrances.end());
+	entrances.erase(std::unique(entrances.begin(), entrances.end()), entrances.end());
+}
+
+int HPAStar::GetBordersAround(int clusterIdx, int* pBorderKeys) const
+{
+	const int clusterCol = clusterIdx % m_NrOfClusterColumns;
+	const int clusterRow = clusterIdx / m_NrOfClusterColumns;
+
+	int nrOfBorders = 0;
+	for (int border = 0; border < NrOfBorders; ++border)
+		pBorderKeys[nrOfBorders++] = clusterIdx * NrOfBorders + border;
+
+	if (clusterCol > 0)
+		pBorderKeys[nrOfBorders++] = GetClusterIdx(clusterCol - 1, clusterRow) * NrOfBorders + East;
+	if (clusterRow > 0)
+		pBorderKeys[nrOfBorders++] = GetClusterIdx(clusterCol, clusterRow - 1) * NrOfBorders + North;
+	if (clusterCol > 0 && clusterRow > 0)
+		pBorderKeys[nrOfBorders++] = GetClusterIdx(clusterCol - 1, clusterRow - 1) * NrOfBorders + NorthEast;
+	if (clusterCol + 1 < m_NrOfClusterColumns && clusterRow > 0)
+		pBorderKeys[nrOfBorders++] = GetClusterIdx(clusterCol + 1, clusterRow - 1) * NrOfBorders + NorthWest;
+
+	return nrOfBorders;
+}
+
+void HPAStar::SearchCluster(int startNodeId, bool isBackward)
+{
+	const int clusterIdx = GetClusterIdx(startNodeId);
+	const bool followIncoming = isBackward && m_pGrid->IsDirectional();
+
+	SearchContext& context = m_ClusterSearchContext;
+	context.BeginSearch(m_pGrid->GetNrOfNodeSlots());
+	IndexedPriorityQueue& openNodes = context.GetOpenList();
+
+	context.SetReached(startNodeId, 0.f, invalid_node_id);
+	openNodes.Push(startNodeId, 0.f);
+
+	while (!openNodes.IsEmpty())
+	{
+		const int currentNodeId = openNodes.Pop();
+		const float currentCostSoFar = context.GetCostSoFar(currentNodeId);
+
+		const std::vector<GraphConnection*>& connections = followIncoming ? m_pGrid->GetConnectionsToNode(currentNodeId) : m_pGrid->GetConnectionsFromNode(currentNodeId);
+		for (const GraphConnection* const pConnection : connections)
+		{
+			const int nextNodeId = followIncoming ? pConnection->GetFromNodeId() : pConnection->GetToNodeId();
+			if (GetClusterIdx(nextNodeId) != clusterIdx)
+				continue;
+
+			const float gCost = currentCostSoFar + pConnection->GetCost();
+			if (gCost >= context.GetCostSoFar(nextNodeId))
+				continue;
+
+			context.SetReached(nextNodeId, gCost, currentNodeId);
+			openNodes.Push(nextNodeId, gCost);
+		}
+	}
+}
+
+int HPAStar::GetClusterIdx(int nodeId) const
+{
+	const auto [row, col] = m_pGrid->GetRowAndColumn(nodeId);
+	return GetClusterIdx(col / m_ClusterSize, row / m_ClusterSize);
+}
+
+int HPAStar::GetNeighborClusterIdx(int clusterIdx, Border border) const
+{
+	const int clusterCol = clusterIdx % m_NrOfClusterColumns;
+	const int clusterRow = clusterIdx / m_NrOfClusterColumns;
+	const bool hasNorth = clusterRow + 1 < m_NrOfClusterRows;
+
+	switch (border)
+	{
+	case East:
+		return clusterCol + 1 < m_NrOfClusterColumns ? GetClusterIdx(clusterCol + 1, clusterRow) : invalid_node_id;
+	case North:
+		return hasNorth ? GetClusterIdx(clusterCol, clusterRow + 1) : invalid_node_id;
+	case NorthEast:
+		return hasNorth && clusterCol + 1 < m_NrOfClusterColumns ? GetClusterIdx(clusterCol + 1, clusterRow + 1) : invalid_node_id;
+	case NorthWest:
+		return hasNorth && clusterCol > 0 ? GetClusterIdx(clusterCol - 1, clusterRow + 1) : invalid_node_id;
+	default:
+		return invalid_node_id;
+	}
+}
+
+void HPAStar::GetClusterBounds(int clusterIdx, int& minCol, int& minRow, int& maxCol, int& maxRow) const
+{
+	minCol = (clusterIdx % m_NrOfClusterColumns) * m_ClusterSize;
+	minRow = (clusterIdx / m_NrOfClusterColumns) * m_ClusterSize;
+	maxCol = std::min(minCol + m_ClusterSize, m_pGrid->GetColumns()) - 1;
+	maxRow = std::min(minRow + m_ClusterSize, m_pGrid->GetRows()) - 1;
+}
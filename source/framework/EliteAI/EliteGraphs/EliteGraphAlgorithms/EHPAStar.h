@@ -0,0 +1,117 @@
+//*=================================================*/
+// EHPAStar.h: Hierarchical pathfinding (HPA*) on a GridGraph. The grid is split in square clusters, the cells where a path
+// crosses from one cluster into the next become entrances in a small abstract graph, together with the cost of the cheapest
+// path between every two entrances of a cluster. A query searches the abstract graph, the grid path is filled in with AStar
+// one abstract step at a time. Edits are read from the change journal of the grid and only rebuild the clusters they touch.
+//*=================================================*/
+
+#pragma once
+#include "EAStar.h"
+#include "../EliteGridGraph/EGridGraph.h"
+
+namespace Elite
+{
+	class HPAStar final
+	{
+	public:
+		// Backward searches between entrances follow the connections into a cell, so a directed grid gets its incoming
+		// connections tracked and keeps them. Undirected grids are not changed
+		HPAStar(GridGraph* const pGrid, int clusterSize, Heuristic hFunction);
+
+		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
+
+		// The cells where the path crosses into another cluster (start and destination included).
+		// Refine them into a grid path with RefinePathSegment when they are needed.
+		bool FindAbstractPath(int startNodeId, int destinationNodeId, std::vector<int>& waypoints);
+		// Appends the grid path between two successive waypoints, the first cell is left out when it is already at the end of the path
+		bool RefinePathSegment(int fromNodeId, int toNodeId, std::vector<int>& path);
+
+		// Rebuilds the clusters that changed since the last call, queries do this by themselves
+		void Update();
+
+		int GetClusterSize() const { return m_ClusterSize; }
+		int GetNrOfClusters() const { return m_NrOfClusterColumns * m_NrOfClusterRows; }
+		const Graph& GetAbstractGraph() const { return m_AbstractGraph; }
+		// Clusters whose entrances were reconnected by the last Update
+		int GetNrOfRebuiltClusters() const { return m_NrOfRebuiltClusters; }
+
+	private:
+		// Borders a cluster owns, the south and west ones belong to the neighbouring clusters
+		enum Border
+		{
+			East,
+			North,
+			NorthEast,
+			NorthWest,
+			NrOfBorders
+		};
+
+		// A pair of cells on both sides of a border that are connected, both become entrances
+		struct Transition
+		{
+			int insideNodeId;
+			int outsideNodeId;
+			bool operator==(const Transition& other) const { return insideNodeId == other.insideNodeId && outsideNodeId == other.outsideNodeId; }
+		};
+
+		// runs of crossings at least this long get an entrance at both ends instead of one in the middle
+		static const int LONG_ENTRANCE_LENGTH = 6;
+
+		GridGraph* m_pGrid;
+		int m_ClusterSize;
+		int m_NrOfClusterColumns;
+		int m_NrOfClusterRows;
+		Heuristic m_HeuristicFunction;
+
+		Graph m_AbstractGraph{ true };
+		std::vector<int> m_AbstractNodeIds{}; // per grid cell, invalid_node_id if the cell is no entrance
+		std::vector<int> m_NrOfTransitions{}; // per grid cell, the entrance is removed when this drops to 0
+		std::vector<int> m_EntranceNodeIds{}; // per abstract node
+		std::vector<std::vector<Transition>> m_Transitions{}; // per cluster and border
+
+		bool m_IsBuilt{ false };
+		unsigned long long m_GraphVersion{ 0 };
+		int m_NrOfRebuiltClusters{ 0 };
+
+		// scratch memory, kept between queries
+		SearchContext m_ClusterSearchContext{};
+		std::vector<unsigned char> m_IsClusterMarked{};
+		std::vector<unsigned char> m_IsBorderMarked{};
+		std::vector<GraphChange> m_Changes{};
+		std::vector<int> m_ChangedClusters{};
+		std::vector<int> m_ClustersToConnect{};
+		std::vector<int> m_MarkedBorders{};
+		std::vector<Transition> m_NewTransitions{};
+		std::vector<int> m_Entrances{};
+		std::vector<int> m_RemovedConnections{};
+		std::vector<int> m_AbstractPath{};
+		std::vector<int> m_Waypoints{};
+		std::vector<int> m_Segment{};
+		std::vector<int> m_PathIds{};
+
+		void BuildAll();
+		void RebuildClusters(const std::vector<int>& changedClusters);
+		void ConnectEntrances(int clusterIdx);
+
+		void FindTransitions(int clusterIdx, Border border, std::vector<Transition>& transitions) const;
+		void AddTransition(const Transition& transition);
+		void AddCrossingConnections(const Transition& transition);
+		void RemoveCrossingConnections(const Transition& transition);
+		void AddEntrance(int nodeId);
+		void RemoveEntrance(int nodeId);
+		void GetEntrances(int clusterIdx, std::vector<int>& entrances) const;
+		// Fills in owner cluster * NrOfBorders + border for the borders around the cluster, returns how many there are
+		int GetBordersAround(int clusterIdx, int* pBorderKeys) const;
+
+		// Dijkstra that doesn't leave the cluster, backwards follows the connections into the nodes
+		void SearchCluster(int startNodeId, bool isBackward);
+
+		bool IsCrossing(int fromNodeId, int toNodeId) const { return m_pGrid->ConnectionExists(fromNodeId, toNodeId) || m_pGrid->ConnectionExists(toNodeId, fromNodeId); }
+		int GetClusterIdx(int nodeId) const;
+		int GetClusterIdx(int clusterCol, int clusterRow) const { return clusterRow * m_NrOfClusterColumns + clusterCol; }
+		int GetNeighborClusterIdx(int clusterIdx, Border border) const;
+		void GetClusterBounds(int clusterIdx, int& minCol, int& minRow, int& maxCol, int& maxRow) const;
+	};
+}
@@ -0,0 +1,150 @@
+//*=================================================*/
+// EIndexedPriorityQueue.h: Binary min-heap of node ids keyed on a float priority.
+// Keeps the heap position of every id, so a node that is already queued can get a lower priority in O(log n)
+//*=================================================*/
+
+#pragma once
+#include <vector>
+
+namespace Elite
+{
+	class IndexedPriorityQueue final
+	{
+	public:
+		IndexedPriorityQueue() = default;
+		explicit IndexedPriorityQueue(int nrOfIds) { Resize(nrOfIds); }
+
+		// Ids have to be in [0, nrOfIds), clears the queue
+		void Resize(int nrOfIds)
+		{
+			m_Heap.clear();
+			m_HeapIndices.assign(nrOfIds, NOT_QUEUED);
+		}
+
+		void Clear()
+		{
+			for (const Entry& entry : m_Heap)
+				m_HeapIndices[entry.id] = NOT_QUEUED;
+			m_Heap.clear();
+		}
+
+		int GetNrOfIds() const { return static_cast<int>(m_HeapIndices.size()); }
+		bool IsEmpty() const { return m_Heap.empty(); }
+		int GetSize() const { return static_cast<int>(m_Heap.size()); }
+		bool Contains(int id) const { return m_HeapIndices[id] != NOT_QUEUED; }
+
+		int GetTop() const { return m_Heap.front().id; }
+		float GetTopPriority() const { return m_Heap.front().priority; }
+		float GetPriority(int id) const { return m_Heap[m_HeapIndices[id]].priority; }
+		// Id at a position in the heap, [0, GetSize()) visits every queued id in no particular order
+		int GetIdAt(int heapIdx) const { return m_Heap[heapIdx].id; }
+
+		// Adds the id, or moves it to the new priority if it is already queued
+		void Push(int id, float priority)
+		{
+			int heapIdx = m_HeapIndices[id];
+			if (heapIdx == NOT_QUEUED)
+			{
+				heapIdx = static_cast<int>(m_Heap.size());
+				m_Heap.push_back(Entry{ id, priority });
+				m_HeapIndices[id] = heapIdx;
+				SiftUp(heapIdx);
+				return;
+			}
+
+			const float oldPriority = m_Heap[heapIdx].priority;
+			m_Heap[heapIdx].priority = priority;
+			if (priority < oldPriority)
+				SiftUp(heapIdx);
+			else
+				SiftDown(heapIdx);
+		}
+
+		int Pop()
+		{
+			const int id = m_Heap.front().id;
+			m_HeapIndices[id] = NOT_QUEUED;
+
+			const Entry last = m_Heap.back();
+			m_Heap.pop_back();
+			if (!m_Heap.empty())
+			{
+				m_Heap.front() = last;
+				m_HeapIndices[last.id] = 0;
+				SiftDown(0);
+			}
+			return id;
+		}
+
+		void Remove(int id)
+		{
+			const int heapIdx = m_HeapIndices[id];
+			if (heapIdx == NOT_QUEUED)
+				return;
+
+			m_HeapIndices[id] = NOT_QUEUED;
+			const Entry last = m_Heap.back();
+			m_Heap.pop_back();
+			if (heapIdx == static_cast<int>(m_Heap.size()))
+				return;
+
+			m_Heap[heapIdx] = last;
+			m_HeapIndices[last.id] = heapIdx;
+			SiftUp(heapIdx);
+			SiftDown(m_HeapIndices[last.id]);
+		}
+
+	private:
+		struct Entry
+		{
+			int id;
+			float priority;
+		};
+
+		static constexpr int NOT_QUEUED = -1;
+
+		std::vector<Entry> m_Heap{};
+		std::vector<int> m_HeapIndices{}; // position of every id in m_Heap, NOT_QUEUED if it isn't in there
+
+		void SiftUp(int heapIdx)
+		{
+			const Entry entry = m_Heap[heapIdx];
+			while (heapIdx > 0)
+			{
+				const int parentIdx = (heapIdx - 1) / 2;
+				if (!(entry.priority < m_Heap[parentIdx].priority))
+					break;
+
+				Place(heapIdx, m_Heap[parentIdx]);
+				heapIdx = parentIdx;
+			}
+			Place(heapIdx, entry);
+		}
+
+		void SiftDown(int heapIdx)
+		{
+			const int size = static_cast<int>(m_Heap.size());
+			const Entry entry = m_Heap[heapIdx];
+			while (true)
+			{
+				int childIdx = 2 * heapIdx + 1;
+				if (childIdx >= size)
+					break;
+				if (childIdx + 1 < size && m_Heap[childIdx + 1].priority < m_Heap[childIdx].priority)
+					++childIdx;
+				if (!(m_Heap[childIdx].priority < entry.priority))
+					break;
+
+				Place(heapIdx, m_Heap[childIdx]);
+				heapIdx = childIdx;
+			}
+			Place(heapIdx, entry);
+		}
+
+		void Place(int heapIdx, const Entry& entry)
+		{
+			m_Heap[heapIdx] = entry;
+			m_HeapIndices[entry.id] = heapIdx;
+		}
+	};
+}
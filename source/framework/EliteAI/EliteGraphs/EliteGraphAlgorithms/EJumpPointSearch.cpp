@@ -0,0 +1,418 @@
+#include "stdafx.h"
+#include "EJumpPointSearch.h"
+
+using namespace Elite;
+
+namespace
+{
+	// counter clockwise, starting east
+	const int DIRECTION_X[] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+	const int DIRECTION_Y[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+}
+
+JumpPointSearch::JumpPointSearch(GridGraph* const pGrid, Heuristic hFunction, bool usePrecomputedJumps)
+	: m_pGrid(pGrid)
+	, m_HeuristicFunction(hFunction)
+	, m_UsePrecomputedJumps(usePrecomputedJumps)
+{
+}
+
+std::vector<GraphNode*> JumpPointSearch::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode)
+{
+	std::vector<GraphNode*> path{};
+	FindPath(pStartNode, pGoalNode, path);
+	return path;
+}
+
+std::vector<int> JumpPointSearch::FindPathIds(int startNodeId, int goalNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, goalNodeId, path);
+	return path;
+}
+
+void JumpPointSearch::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, std::vector<GraphNode*>& path)
+{
+	FindPathIds(pStartNode->GetId(), pGoalNode->GetId(), m_PathIds);
+
+	path.clear();
+	for (int nodeId : m_PathIds)
+		path.push_back(m_pGrid->GetNode(nodeId));
+}
+
+void JumpPointSearch::FindPathIds(int startNodeId, int goalNodeId, std::vector<int>& path)
+{
+	path.clear();
+
+	if (!CanJump())
+	{
+		m_NrOfExpandedNodes = 0;
+		AStar fallback{ m_pGrid, m_HeuristicFunction };
+		fallback.SetSearchContext(m_pSearchContext);
+		fallback.FindPathIds(startNodeId, goalNodeId, path);
+		return;
+	}
+
+	SearchContext& context = m_pSearchContext != nullptr ? *m_pSearchContext : SearchContext::GetThreadContext();
+	if (!Search(startNodeId, goalNodeId, context))
+		return;
+
+	// jump points are connected by straight or diagonal lines, fill in the cells in between
+	for (int nodeId = goalNodeId; nodeId != invalid_node_id;)
+	{
+		path.push_back(nodeId);
+
+		const int parentNodeId = context.GetParent(nodeId);
+		if (parentNodeId == invalid_node_id)
+			break;
+
+		auto [row, col] = m_pGrid->GetRowAndColumn(nodeId);
+		const auto [parentRow, parentCol] = m_pGrid->GetRowAndColumn(parentNodeId);
+		const int dx = Sign(parentCol - col);
+		const int dy = Sign(parentRow - row);
+		for (col += dx, row += dy; col != parentCol || row != parentRow; col += dx, row += dy)
+			path.push_back(m_pGrid->GetNodeId(col, row));
+
+		nodeId = parentNodeId;
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+bool JumpPointSearch::CanJump()
+{
+	Prepare();
+	return m_CanJump;
+}
+
+void JumpPointSearch::Prepare()
+{
+	const unsigned long long version = m_pGrid->GetVersion();
+	if (m_IsPrepared && version == m_PreparedVersion)
+		return;
+
+	m_IsPrepared = true;
+	m_PreparedVersion = version;
+	m_CanJump = HasUniformConnections();
+
+	if (m_CanJump && m_UsePrecomputedJumps)
+		PrecomputeJumpDistances();
+	else
+		m_JumpDistances.clear();
+}
+
+// Jumping assumes that every open cell is connected to all its open neighbours with one cost for straight and one for diagonal connections
+bool JumpPointSearch::HasUniformConnections()
+{
+	const int nrOfCells = m_pGrid->GetRows() * m_pGrid->GetColumns();
+
+	m_IsOpen.assign(nrOfCells, 0);
+	for (int nodeId = 0; nodeId < nrOfCells; ++nodeId)
+	{
+		if (m_pGrid->IsNodeValid(nodeId) && !m_pGrid->GetConnectionsFromNode(nodeId).empty())
+			m_IsOpen[nodeId] = 1;
+	}
+
+	float costStraight = -1.f;
+	float costDiagonal = -1.f;
+	for (int nodeId = 0; nodeId < nrOfCells; ++nodeId)
+	{
+		if (m_IsOpen[nodeId] == 0)
+			continue;
+
+		const auto [row, col] = m_pGrid->GetRowAndColumn(nodeId);
+		int nrOfOpenNeighbors = 0;
+		for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+		{
+			if (IsOpen(col + DIRECTION_X[direction], row + DIRECTION_Y[direction]))
+				++nrOfOpenNeighbors;
+		}
+
+		const std::vector<GraphConnection*>& connections = m_pGrid->GetConnectionsFromNode(nodeId);
+		if (static_cast<int>(connections.size()) != nrOfOpenNeighbors)
+			return false;
+
+		unsigned int connectedDirections = 0;
+		for (const GraphConnection* const pConnection : connections)
+		{
+			const auto [toRow, toCol] = m_pGrid->GetRowAndColumn(pConnection->GetToNodeId());
+			const int dx = toCol - col;
+			const int dy = toRow - row;
+			if (abs(dx) > 1 || abs(dy) > 1 || (dx == 0 && dy == 0) || m_IsOpen[pConnection->GetToNodeId()] == 0)
+				return false;
+
+			const unsigned int directionBit = 1u << GetDirection(dx, dy);
+			if ((connectedDirections & directionBit) != 0)
+				return false;
+			connectedDirections |= directionBit;
+
+			float& expectedCost = dx != 0 && dy != 0 ? costDiagonal : costStraight;
+			if (expectedCost < 0.f)
+				expectedCost = pConnection->GetCost();
+			else if (pConnection->GetCost() != expectedCost)
+				return false;
+		}
+	}
+
+	// a cost that never shows up can't make the heuristic overestimate as long as it stays within these bounds
+	if (costStraight < 0.f && costDiagonal < 0.f)
+		costStraight = 1.f;
+	if (costStraight < 0.f)
+		costStraight = costDiagonal * 0.5f;
+	if (costDiagonal < 0.f)
+		costDiagonal = costStraight * 2.f;
+
+	m_CostStraight = costStraight;
+	m_CostDiagonal = costDiagonal;
+
+	// outside of these bounds skipping the symmetric paths is no longer guaranteed to keep the shortest one
+	return costStraight > 0.f && costStraight <= costDiagonal && costDiagonal <= 2.f * costStraight;
+}
+
+// JPS+: the jump of every open cell in every direction ignoring the goal, so a search only has to look it up
+void JumpPointSearch::PrecomputeJumpDistances()
+{
+	const int nrOfColumns = m_pGrid->GetColumns();
+	const int nrOfRows = m_pGrid->GetRows();
+	m_JumpDistances.assign(static_cast<size_t>(nrOfColumns) * nrOfRows * NR_OF_DIRECTIONS, 0);
+
+	// straight directions first, the diagonal ones are built on top of them
+	for (int direction : { 0, 2, 4, 6, 1, 3, 5, 7 })
+	{
+		const int dx = DIRECTION_X[direction];
+		const int dy = DIRECTION_Y[direction];
+		const bool isDiagonal = dx != 0 && dy != 0;
+
+		// visit the cells against the direction, so the next cell in the direction is always done already
+		for (int i = 0; i < nrOfRows; ++i)
+		{
+			const int row = dy > 0 ? nrOfRows - 1 - i : i;
+			for (int j = 0; j < nrOfColumns; ++j)
+			{
+				const int col = dx > 0 ? nrOfColumns - 1 - j : j;
+				const int nextCol = col + dx;
+				const int nextRow = row + dy;
+				if (!IsOpen(col, row) || !IsOpen(nextCol, nextRow))
+					continue;
+
+				const int nextIdx = m_pGrid->GetNodeId(nextCol, nextRow) * NR_OF_DIRECTIONS;
+				const bool isNextJumpPoint = isDiagonal
+					? IsDiagonalJumpPoint(nextCol, nextRow, dx, dy) || m_JumpDistances[nextIdx + GetDirection(dx, 0)] > 0 || m_JumpDistances[nextIdx + GetDirection(0, dy)] > 0
+					: IsStraightJumpPoint(nextCol, nextRow, dx, dy);
+
+				const int nextDistance = m_JumpDistances[nextIdx + direction];
+				int& distance = m_JumpDistances[m_pGrid->GetNodeId(col, row) * NR_OF_DIRECTIONS + direction];
+				if (isNextJumpPoint)
+					distance = 1;
+				else
+					distance = nextDistance > 0 ? nextDistance + 1 : nextDistance - 1;
+			}
+		}
+	}
+}
+
+// Same as A*, but the successors of a node are the jump points found in the directions that can't be reached cheaper through its parent
+bool JumpPointSearch::Search(int startNodeId, int goalNodeId, SearchContext& context)
+{
+	m_NrOfExpandedNodes = 0;
+	context.BeginSearch(m_pGrid->GetNrOfNodeSlots());
+	if (startNodeId != goalNodeId && (m_IsOpen[startNodeId] == 0 || m_IsOpen[goalNodeId] == 0))
+		return false;
+
+	IndexedPriorityQueue& openNodes = context.GetOpenList();
+	const auto [goalRow, goalCol] = m_pGrid->GetRowAndColumn(goalNodeId);
+	const auto [startRow, startCol] = m_pGrid->GetRowAndColumn(startNodeId);
+
+	context.SetReached(startNodeId, 0.f, invalid_node_id);
+	openNodes.Push(startNodeId, GetHeuristicCost(startCol, startRow, goalCol, goalRow));
+
+	int directions[NR_OF_DIRECTIONS];
+	while (!openNodes.IsEmpty())
+	{
+		const int currentNodeId = openNodes.Pop();
+		++m_NrOfExpandedNodes;
+		if (currentNodeId == goalNodeId)
+			return true;
+
+		const auto [row, col] = m_pGrid->GetRowAndColumn(currentNodeId);
+		int dx = 0;
+		int dy = 0;
+		const int parentNodeId = context.GetParent(currentNodeId);
+		if (parentNodeId != invalid_node_id)
+		{
+			const auto [parentRow, parentCol] = m_pGrid->GetRowAndColumn(parentNodeId);
+			dx = Sign(col - parentCol);
+			dy = Sign(row - parentRow);
+		}
+
+		const float currentCostSoFar = context.GetCostSoFar(currentNodeId);
+		const int nrOfDirections = GetSuccessorDirections(col, row, dx, dy, directions);
+		for (int i = 0; i < nrOfDirections; ++i)
+		{
+			const int direction = directions[i];
+			int nrOfSteps = 0;
+			const int successorNodeId = m_UsePrecomputedJumps
+				? LookUpJump(col, row, direction, goalCol, goalRow, nrOfSteps)
+				: Jump(col, row, DIRECTION_X[direction], DIRECTION_Y[direction], goalCol, goalRow, nrOfSteps);
+			if (successorNodeId == invalid_node_id)
+				continue;
+
+			const bool isDiagonal = DIRECTION_X[direction] != 0 && DIRECTION_Y[direction] != 0;
+			const float gCost = currentCostSoFar + nrOfSteps * (isDiagonal ? m_CostDiagonal : m_CostStraight);
+			if (gCost >= context.GetCostSoFar(successorNodeId))
+				continue;
+
+			const auto [successorRow, successorCol] = m_pGrid->GetRowAndColumn(successorNodeId);
+			context.SetReached(successorNodeId, gCost, currentNodeId);
+			openNodes.Push(successorNodeId, gCost + GetHeuristicCost(successorCol, successorRow, goalCol, goalRow));
+		}
+	}
+
+	return false;
+}
+
+// The natural neighbours in the direction of travel plus the forced ones next to blocked cells, every direction for the start node
+int JumpPointSearch::GetSuccessorDirections(int col, int row, int dx, int dy, int* pDirections) const
+{
+	int nrOfDirections = 0;
+	auto addDirection = [&](int x, int y) { pDirections[nrOfDirections++] = GetDirection(x, y); };
+
+	if (dx == 0 && dy == 0)
+	{
+		for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+			pDirections[nrOfDirections++] = direction;
+	}
+	else if (dx != 0 && dy != 0)
+	{
+		addDirection(0, dy);
+		addDirection(dx, 0);
+		addDirection(dx, dy);
+		if (!IsOpen(col - dx, row))
+			addDirection(-dx, dy);
+		if (!IsOpen(col, row - dy))
+			addDirection(dx, -dy);
+	}
+	else if (dx != 0)
+	{
+		addDirection(dx, 0);
+		if (!IsOpen(col, row + 1))
+			addDirection(dx, 1);
+		if (!IsOpen(col, row - 1))
+			addDirection(dx, -1);
+	}
+	else
+	{
+		addDirection(0, dy);
+		if (!IsOpen(col + 1, row))
+			addDirection(1, dy);
+		if (!IsOpen(col - 1, row))
+			addDirection(-1, dy);
+	}
+	return nrOfDirections;
+}
+
+// Walks from the cell in the direction until it hits the goal, a jump point (returns its id) or a blocked cell (returns invalid_node_id)
+int JumpPointSearch::Jump(int col, int row, int dx, int dy, int goalCol, int goalRow, int& nrOfSteps) const
+{
+	const bool isDiagonal = dx != 0 && dy != 0;
+	nrOfSteps = 0;
+	while (true)
+	{
+		col += dx;
+		row += dy;
+		++nrOfSteps;
+
+		if (!IsOpen(col, row))
+			return invalid_node_id;
+		if (col == goalCol && row == goalRow)
+			return m_pGrid->GetNodeId(col, row);
+
+		if (isDiagonal)
+		{
+			if (IsDiagonalJumpPoint(col, row, dx, dy))
+				return m_pGrid->GetNodeId(col, row);
+
+			// a diagonal cell is also a jump point when one of the straight lines leaving it finds one
+			int nrOfStraightSteps = 0;
+			if (Jump(col, row, dx, 0, goalCol, goalRow, nrOfStraightSteps) != invalid_node_id
+				|| Jump(col, row, 0, dy, goalCol, goalRow, nrOfStraightSteps) != invalid_node_id)
+				return m_pGrid->GetNodeId(col, row);
+		}
+		else if (IsStraightJumpPoint(col, row, dx, dy))
+		{
+			return m_pGrid->GetNodeId(col, row);
+		}
+	}
+}
+
+// JPS+ version of Jump, the precomputed distances don't know the goal so that is checked here
+int JumpPointSearch::LookUpJump(int col, int row, int direction, int goalCol, int goalRow, int& nrOfSteps) const
+{
+	const int dx = DIRECTION_X[direction];
+	const int dy = DIRECTION_Y[direction];
+	const int distance = m_JumpDistances[m_pGrid->GetNodeId(col, row) * NR_OF_DIRECTIONS + direction];
+	const int maxNrOfSteps = distance > 0 ? distance : -distance;
+
+	const int toGoalX = goalCol - col;
+	const int toGoalY = goalRow - row;
+	if (dx != 0 && dy != 0)
+	{
+		// the goal can only be found by a straight jump from the diagonal cell that shares its row or column
+		if (Sign(toGoalX) == dx && Sign(toGoalY) == dy)
+		{
+			const int nrOfStepsToGoalLine = std::min(abs(toGoalX), abs(toGoalY));
+			if (nrOfStepsToGoalLine <= maxNrOfSteps)
+			{
+				nrOfSteps = nrOfStepsToGoalLine;
+				return m_pGrid->GetNodeId(col + nrOfSteps * dx, row + nrOfSteps * dy);
+			}
+		}
+	}
+	else
+	{
+		const bool isGoalAhead = dx != 0
+			? toGoalY == 0 && Sign(toGoalX) == dx && abs(toGoalX) <= maxNrOfSteps
+			: toGoalX == 0 && Sign(toGoalY) == dy && abs(toGoalY) <= maxNrOfSteps;
+		if (isGoalAhead)
+		{
+			nrOfSteps = abs(toGoalX) + abs(toGoalY);
+			return m_pGrid->GetNodeId(goalCol, goalRow);
+		}
+	}
+
+	if (distance <= 0)
+		return invalid_node_id;
+
+	nrOfSteps = distance;
+	return m_pGrid->GetNodeId(col + distance * dx, row + distance * dy);
+}
+
+// Moving straight, a cell is a jump point when a blocked cell beside it hides a neighbour further ahead
+bool JumpPointSearch::IsStraightJumpPoint(int col, int row, int dx, int dy) const
+{
+	if (dx != 0)
+		return (IsOpen(col + dx, row + 1) && !IsOpen(col, row + 1)) || (IsOpen(col + dx, row - 1) && !IsOpen(col, row - 1));
+	return (IsOpen(col + 1, row + dy) && !IsOpen(col + 1, row)) || (IsOpen(col - 1, row + dy) && !IsOpen(col - 1, row));
+}
+
+bool JumpPointSearch::IsDiagonalJumpPoint(int col, int row, int dx, int dy) const
+{
+	return (IsOpen(col - dx, row + dy) && !IsOpen(col - dx, row)) || (IsOpen(col + dx, row - dy) && !IsOpen(col, row - dy));
+}
+
+// Octile distance in grid cells with the costs of the grid, exact on an empty grid
+float JumpPointSearch::GetHeuristicCost(int col, int row, int goalCol, int goalRow) const
+{
+	const int dx = abs(goalCol - col);
+	const int dy = abs(goalRow - row);
+	return m_CostDiagonal * std::min(dx, dy) + m_CostStraight * abs(dx - dy);
+}
+
+int JumpPointSearch::GetDirection(int dx, int dy)
+{
+	for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+	{
+		if (DIRECTION_X[direction] == dx && DIRECTION_Y[direction] == dy)
+			return direction;
+	}
+	return 0;
+}
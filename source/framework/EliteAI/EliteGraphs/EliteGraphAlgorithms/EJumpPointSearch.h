@@ -0,0 +1,70 @@
+//*=================================================*/
+// EJumpPointSearch.h: Jump Point Search on an 8-connected GridGraph with uniform straight and diagonal costs.
+// Instead of adding every neighbour to the open list, the search jumps along straight and diagonal lines
+// and only stops at cells where a different path could be shorter (jump points).
+// Optionally the jumps are precomputed per cell and direction (JPS+), those tables are rebuilt after the grid changed.
+// Grids that don't fit (terrain costs, 4-connected, edited connections that don't match blocked cells) are searched with A*.
+//*=================================================*/
+
+#pragma once
+#include "EAStar.h"
+#include "../EliteGridGraph/EGridGraph.h"
+
+namespace Elite
+{
+	class JumpPointSearch final
+	{
+	public:
+		// The heuristic is only used by the A* fallback, jumps use the octile distance with the costs of the grid
+		JumpPointSearch(GridGraph* const pGrid, Heuristic hFunction, bool usePrecomputedJumps = false);
+
+		// Scratch memory for the searches, uses the context of the calling thread when none is set
+		void SetSearchContext(SearchContext* const pContext) { m_pSearchContext = pContext; }
+
+		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
+
+		// False if the grid has to be searched with A*
+		bool CanJump();
+		// Jump points taken from the open list during the last search (0 after an A* fallback)
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+
+	private:
+		static const int NR_OF_DIRECTIONS = 8;
+
+		GridGraph* m_pGrid;
+		Heuristic m_HeuristicFunction;
+		bool m_UsePrecomputedJumps;
+		SearchContext* m_pSearchContext = nullptr;
+
+		// Everything below is derived from the grid and rebuilt when its version changes
+		bool m_IsPrepared{ false };
+		unsigned long long m_PreparedVersion{ 0 };
+		bool m_CanJump{ false };
+		float m_CostStraight{ 1.f };
+		float m_CostDiagonal{ 1.5f };
+		std::vector<unsigned char> m_IsOpen{}; // cells that are connected to every open neighbour
+		std::vector<int> m_JumpDistances{}; // JPS+ only, per cell and direction: > 0 steps to the next jump point, <= 0 minus the steps to the wall
+
+		int m_NrOfExpandedNodes{ 0 };
+		std::vector<int> m_PathIds{};
+
+		void Prepare();
+		bool HasUniformConnections();
+		void PrecomputeJumpDistances();
+
+		bool Search(int startNodeId, int goalNodeId, SearchContext& context);
+		int GetSuccessorDirections(int col, int row, int dx, int dy, int* pDirections) const;
+		int Jump(int col, int row, int dx, int dy, int goalCol, int goalRow, int& nrOfSteps) const;
+		int LookUpJump(int col, int row, int direction, int goalCol, int goalRow, int& nrOfSteps) const;
+
+		bool IsOpen(int col, int row) const { return m_pGrid->IsWithinBounds(col, row) && m_IsOpen[m_pGrid->GetNodeId(col, row)] != 0; }
+		bool IsStraightJumpPoint(int col, int row, int dx, int dy) const;
+		bool IsDiagonalJumpPoint(int col, int row, int dx, int dy) const;
+		float GetHeuristicCost(int col, int row, int goalCol, int goalRow) const;
+
+		static int GetDirection(int dx, int dy);
+	};
+}
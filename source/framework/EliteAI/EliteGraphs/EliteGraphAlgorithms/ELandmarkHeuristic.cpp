@@ -0,0 +1,145 @@
+#include "stdafx.h"
+#include "ELandmarkHeuristic.h"
+#include "../EliteGraph/EGraphConnection.h"
+
+using namespace Elite;
+
+LandmarkHeuristic::LandmarkHeuristic(Graph* const pGraph, int nrOfLandmarks)
+	: m_pGraph(pGraph)
+	, m_MaxNrOfLandmarks(nrOfLandmarks)
+{
+	assert(nrOfLandmarks > 0 && "LandmarkHeuristic: needs at least one landmark");
+
+	// the costs to a landmark are found by searching backwards from it
+	if (m_pGraph->IsDirectional() && !m_pGraph->IsTrackingIncomingConnections())
+		m_pGraph->SetTrackIncomingConnections(true);
+
+	Rebuild();
+}
+
+void LandmarkHeuristic::Rebuild()
+{
+	m_Version = m_pGraph->GetVersion();
+	m_NrOfNodeSlots = m_pGraph->GetNrOfNodeSlots();
+	m_Landmarks.clear();
+
+	const int nrOfLandmarks = std::min(m_MaxNrOfLandmarks, m_pGraph->GetAmountOfNodes());
+	m_CostsFromLandmarks.assign(static_cast<size_t>(m_NrOfNodeSlots) * nrOfLandmarks, FLT_MAX);
+	m_CostsToLandmarks.assign(m_pGraph->IsDirectional() ? m_CostsFromLandmarks.size() : 0, FLT_MAX);
+	if (nrOfLandmarks == 0)
+		return;
+
+	int firstNodeId = 0;
+	while (!m_pGraph->IsNodeValid(firstNodeId))
+		++firstNodeId;
+
+	// the node farthest from any node lies on the edge of the graph, which makes a good first landmark
+	SearchContext context{};
+	SearchCosts(context, firstNodeId, false);
+	int landmarkNodeId = firstNodeId;
+	for (int nodeId = 0; nodeId < m_NrOfNodeSlots; ++nodeId)
+	{
+		if (context.IsReached(nodeId) && context.GetCostSoFar(nodeId) > context.GetCostSoFar(landmarkNodeId))
+			landmarkNodeId = nodeId;
+	}
+
+	// cost to the nearest landmark so far, the next landmark is the node where this is highest
+	std::vector<float> nearestLandmarkCosts(m_NrOfNodeSlots, FLT_MAX);
+	for (int landmarkIdx = 0; landmarkIdx < nrOfLandmarks; ++landmarkIdx)
+	{
+		m_Landmarks.push_back(landmarkNodeId);
+
+		SearchCosts(context, landmarkNodeId, false);
+		for (int nodeId = 0; nodeId < m_NrOfNodeSlots; ++nodeId)
+		{
+			const float cost = context.GetCostSoFar(nodeId);
+			m_CostsFromLandmarks[static_cast<size_t>(nodeId) * nrOfLandmarks + landmarkIdx] = cost;
+			nearestLandmarkCosts[nodeId] = std::min(nearestLandmarkCosts[nodeId], cost);
+		}
+
+		if (m_pGraph->IsDirectional())
+		{
+			SearchCosts(context, landmarkNodeId, true);
+			for (int nodeId = 0; nodeId < m_NrOfNodeSlots; ++nodeId)
+				m_CostsToLandmarks[static_cast<size_t>(nodeId) * nrOfLandmarks + landmarkIdx] = context.GetCostSoFar(nodeId);
+		}
+
+		// nodes that no landmark reaches come first, so every part of the graph gets a landmark
+		landmarkNodeId = invalid_node_id;
+		for (int nodeId = 0; nodeId < m_NrOfNodeSlots; ++nodeId)
+		{
+			if (!m_pGraph->IsNodeValid(nodeId) || std::find(m_Landmarks.begin(), m_Landmarks.end(), nodeId) != m_Landmarks.end())
+				continue;
+			if (landmarkNodeId == invalid_node_id || nearestLandmarkCosts[nodeId] > nearestLandmarkCosts[landmarkNodeId])
+				landmarkNodeId = nodeId;
+		}
+		if (landmarkNodeId == invalid_node_id)
+			break;
+	}
+}
+
+float LandmarkHeuristic::GetCost(int fromNodeId, int toNodeId) const
+{
+	if ((unsigned int)fromNodeId >= (unsigned int)m_NrOfNodeSlots || (unsigned int)toNodeId >= (unsigned int)m_NrOfNodeSlots)
+		return 0.f;
+
+	const size_t nrOfLandmarks = m_Landmarks.size();
+	const float* const pFromCosts = m_CostsFromLandmarks.data() + fromNodeId * nrOfLandmarks;
+	const float* const pToCosts = m_CostsFromLandmarks.data() + toNodeId * nrOfLandmarks;
+	const bool isDirectional = !m_CostsToLandmarks.empty();
+
+	float lowerBound = 0.f;
+	for (size_t landmarkIdx = 0; landmarkIdx < nrOfLandmarks; ++landmarkIdx)
+	{
+		// landmarks that can't reach both nodes say nothing
+		if (pFromCosts[landmarkIdx] != FLT_MAX && pToCosts[landmarkIdx] != FLT_MAX)
+		{
+			// cost(L, to) <= cost(L, from) + cost(from, to), on undirected graphs also the other way around
+			lowerBound = std::max(lowerBound, pToCosts[landmarkIdx] - pFromCosts[landmarkIdx]);
+			if (!isDirectional)
+				lowerBound = std::max(lowerBound, pFromCosts[landmarkIdx] - pToCosts[landmarkIdx]);
+		}
+	}
+
+	if (isDirectional)
+	{
+		// cost(from, L) <= cost(from, to) + cost(to, L)
+		const float* const pFromCostsToLandmarks = m_CostsToLandmarks.data() + fromNodeId * nrOfLandmarks;
+		const float* const pToCostsToLandmarks = m_CostsToLandmarks.data() + toNodeId * nrOfLandmarks;
+		for (size_t landmarkIdx = 0; landmarkIdx < nrOfLandmarks; ++landmarkIdx)
+		{
+			if (pFromCostsToLandmarks[landmarkIdx] != FLT_MAX && pToCostsToLandmarks[landmarkIdx] != FLT_MAX)
+				lowerBound = std::max(lowerBound, pFromCostsToLandmarks[landmarkIdx] - pToCostsToLandmarks[landmarkIdx]);
+		}
+	}
+
+	return lowerBound;
+}
+
+// Dijkstra over the whole graph, the costs can be read from the context afterwards
+void LandmarkHeuristic::SearchCosts(SearchContext& context, int landmarkNodeId, bool isBackward) const
+{
+	context.BeginSearch(m_NrOfNodeSlots);
+	IndexedPriorityQueue& openNodes = context.GetOpenList();
+
+	context.SetReached(landmarkNodeId, 0.f, invalid_node_id);
+	openNodes.Push(landmarkNodeId, 0.f);
+
+	while (!openNodes.IsEmpty())
+	{
+		const int currentNodeId = openNodes.Pop();
+		const float currentCostSoFar = context.GetCostSoFar(currentNodeId);
+
+		const std::vector<GraphConnection*>& connections = isBackward ? m_pGraph->GetConnectionsToNode(currentNodeId) : m_pGraph->GetConnectionsFromNode(currentNodeId);
+		for (const GraphConnection* const pConnection : connections)
+		{
+			const int nextNodeId = isBackward ? pConnection->GetFromNodeId() : pConnection->GetToNodeId();
+			const float gCost = currentCostSoFar + pConnection->GetCost();
+			if (gCost >= context.GetCostSoFar(nextNodeId))
+				continue;
+
+			context.SetReached(nextNodeId, gCost, currentNodeId);
+			openNodes.Push(nextNodeId, gCost);
+		}
+	}
+}
@@ -0,0 +1,45 @@
+//*=================================================*/
+// ELandmarkHeuristic.h: ALT heuristic (A*, Landmarks, Triangle inequality). A few landmark nodes are picked far apart and
+// the cost from (and on directed graphs to) every landmark is stored per node. By the triangle inequality
+// cost(L, goal) - cost(L, node) can never be more than the real cost from node to goal, so it is a lower bound that follows
+// walls and expensive terrain where the geometric heuristics only see the straight line.
+//*=================================================*/
+
+#pragma once
+#include "../EliteGraph/EGraph.h"
+#include "ESearchContext.h"
+
+namespace Elite
+{
+	class LandmarkHeuristic final
+	{
+	public:
+		// Directed graphs also need the costs to the landmarks, the incoming connections of the graph are tracked for that.
+		// The tracking stays on for that graph, undirected graphs are not changed
+		LandmarkHeuristic(Graph* const pGraph, int nrOfLandmarks);
+
+		// Picks the landmarks and runs the Dijkstras again. The tables belong to one version of the graph,
+		// AStar ignores them after an edit until this is called
+		void Rebuild();
+
+		// Lower bound on the cost of the cheapest path, 0 for ids without a table (e.g. nodes of a GraphOverlay)
+		float GetCost(int fromNodeId, int toNodeId) const;
+
+		unsigned long long GetVersion() const { return m_Version; }
+		int GetNrOfLandmarks() const { return static_cast<int>(m_Landmarks.size()); }
+		const std::vector<int>& GetLandmarks() const { return m_Landmarks; }
+
+	private:
+		Graph* m_pGraph;
+		int m_MaxNrOfLandmarks;
+		unsigned long long m_Version{ 0 };
+		int m_NrOfNodeSlots{ 0 };
+
+		std::vector<int> m_Landmarks{};
+		// per node all landmarks next to each other, FLT_MAX where there is no path
+		std::vector<float> m_CostsFromLandmarks{};
+		std::vector<float> m_CostsToLandmarks{}; // directed graphs only
+
+		void SearchCosts(SearchContext& context, int landmarkNodeId, bool isBackward) const;
+	};
+}
@@ -31,46 +31,44 @@ std::vector<Vector2> NavMeshPathfinding::FindPath(const Vector2& startPos, const
 
 
 	//=> Start looking for a path
-	//Clone the graph (returns shared_ptr!)
-	std::shared_ptr<Elite::NavGraph> pNavGraphClone = pNavGraph->Clone();
+	//Layer the Start and End Node on top of the graph, the graph itself is shared and stays untouched
+	GraphOverlay overlay{ pNavGraph };
 
-	//Create extra node for the Start Node (Agent's position) and add it to the graph. 
-	
-	int startPositionNodeId = pNavGraphClone->AddNode(new NavGraphNode(-1,startPos));
+	//Create extra node for the Start Node (Agent's position) and add it to the overlay. 
+	int startPositionNodeId = overlay.AddNode(new NavGraphNode(-1,startPos));
 
 	//Make connections between the Start Node and the startTriangle nodes.
 	for (int lineId : startTriangle->metaData.IndexLines)
 	{
-		int nodeId = pNavGraphClone->GetNodeIdFromLineIndex(lineId);
+		int nodeId = pNavGraph->GetNodeIdFromLineIndex(lineId);
 
 		if (nodeId != invalid_node_id)
 		{
-			pNavGraphClone->AddConnection(new GraphConnection(startPositionNodeId, nodeId));
+			overlay.AddConnection(startPositionNodeId, nodeId, Distance(startPos, pNavGraph->GetNodePos(nodeId)));
 		}
 		
 	}
 
-	//Create extra node for the End Node (endpos) and add it to the graph. 
-	int endPositionNodeId = pNavGraphClone->AddNode(new NavGraphNode(-1,endPos));
+	//Create extra node for the End Node (endpos) and add it to the overlay. 
+	int endPositionNodeId = overlay.AddNode(new NavGraphNode(-1,endPos));
 	//Make connections between the End Node and the endTriangle nodes.
 
 	for (int lineId : endTriangle->metaData.IndexLines)
 	{
-		int nodeId = pNavGraphClone->GetNodeIdFromLineIndex(lineId);
+		int nodeId = pNavGraph->GetNodeIdFromLineIndex(lineId);
 
 		if (nodeId != invalid_node_id)
 		{
-			pNavGraphClone->AddConnection(new GraphConnection(endPositionNodeId, nodeId));
+			overlay.AddConnection(endPositionNodeId, nodeId, Distance(endPos, pNavGraph->GetNodePos(nodeId)));
 		}
 
 	}
-	pNavGraphClone->SetConnectionCostsToDistances();
 
 
-	//Run AStar on the new graph
-	Elite::AStar aStar{ pNavGraphClone.get(), Elite::HeuristicFunctions::Chebyshev};
+	//Run AStar on the graph with the overlay
+	Elite::AStar aStar{ &overlay, Elite::HeuristicFunctions::Chebyshev};
 
-	std::vector<GraphNode*> calculatedPath = aStar.FindPath(pNavGraphClone->GetNode(startPositionNodeId), pNavGraphClone->GetNode(endPositionNodeId));
+	std::vector<GraphNode*> calculatedPath = aStar.FindPath(overlay.GetNode(startPositionNodeId), overlay.GetNode(endPositionNodeId));
 	
 	for (auto node : calculatedPath)
 	{
@@ -0,0 +1,175 @@
+#include "stdafx.h"
+#include "EPathCache.h"
+
+#include "ENavGraphPathfinding.h"
+#include "../EliteNavGraph/ENavGraph.h"
+
+using namespace Elite;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	float GetMicrosecondsSince(const Clock::time_point& startTime)
+	{
+		return std::chrono::duration<float, std::micro>(Clock::now() - startTime).count();
+	}
+
+	int GetTriangleIndex(const Polygon* const pPolygon, const Vector2& position)
+	{
+		const Triangle* const pTriangle = pPolygon->GetTriangleFromPosition(position);
+		if (pTriangle == nullptr)
+			return -1;
+
+		const std::vector<Triangle*>& triangles = pPolygon->GetTriangles();
+		return static_cast<int>(std::find(triangles.begin(), triangles.end(), pTriangle) - triangles.begin());
+	}
+}
+
+size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<const void*>()(key.pGraph);
+	hash = hash * 31 + std::hash<int>()(key.startId);
+	hash = hash * 31 + std::hash<int>()(key.goalId);
+	return hash * 31 + std::hash<unsigned long long>()(key.version);
+}
+
+PathCache::PathCache(size_t memoryBudget)
+	: m_MemoryBudget(memoryBudget)
+{
+}
+
+std::vector<Vector2> PathCache::FindPath(const Vector2& startPos, const Vector2& endPos, NavGraph* const pNavGraph)
+{
+	const Clock::time_point startTime = Clock::now();
+
+	const Polygon* const pNavMesh = pNavGraph->GetNavMeshPolygon();
+	const int startTriangleIdx = GetTriangleIndex(pNavMesh, startPos);
+	const int endTriangleIdx = GetTriangleIndex(pNavMesh, endPos);
+	// off the navmesh or inside one triangle there is nothing to search
+	if (startTriangleIdx == -1 || endTriangleIdx == -1 || startTriangleIdx == endTriangleIdx)
+		return NavMeshPathfinding::FindPath(startPos, endPos, pNavGraph);
+
+	const Key key{ pNavGraph, startTriangleIdx, endTriangleIdx, pNavGraph->GetVersion() };
+	if (const Entry* const pEntry = Find(key))
+	{
+		if (!pEntry->hasPath)
+		{
+			m_Stats.savedMicroseconds += pEntry->searchMicroseconds - GetMicrosecondsSince(startTime);
+			return {};
+		}
+
+		// the corridor stays the same, only the funnel depends on the exact start and goal
+		std::vector<Portal> portals{};
+		portals.reserve(pEntry->portalPoints.size() / 2 + 2);
+		portals.emplace_back(Line(startPos, startPos));
+		for (size_t pointIdx = 0; pointIdx + 1 < pEntry->portalPoints.size(); pointIdx += 2)
+			portals.emplace_back(Line(pEntry->portalPoints[pointIdx], pEntry->portalPoints[pointIdx + 1]));
+		portals.emplace_back(Line(endPos, endPos));
+
+		std::vector<Vector2> path = SSFA::OptimizePortals(portals);
+		m_Stats.savedMicroseconds += pEntry->searchMicroseconds - GetMicrosecondsSince(startTime);
+		return path;
+	}
+
+	std::vector<Vector2> debugNodePositions{};
+	std::vector<Portal> portals{};
+	std::vector<Vector2> path = NavMeshPathfinding::FindPath(startPos, endPos, pNavGraph, debugNodePositions, portals);
+
+	Entry entry{ key };
+	entry.hasPath = !path.empty();
+	// the first and last portal are the start and goal themselves
+	for (size_t portalIdx = 1; portalIdx + 1 < portals.size(); ++portalIdx)
+	{
+		entry.portalPoints.push_back(portals[portalIdx].Line.p1);
+		entry.portalPoints.push_back(portals[portalIdx].Line.p2);
+	}
+	entry.searchMicroseconds = GetMicrosecondsSince(startTime);
+	Add(std::move(entry));
+	return path;
+}
+
+std::vector<GraphNode*> PathCache::FindPath(AStar& pathfinder, Graph* const pGraph, GraphNode* const pStartNode, GraphNode* const pGoalNode)
+{
+	const Clock::time_point startTime = Clock::now();
+	std::vector<GraphNode*> path{};
+
+	const Key key{ pGraph, pStartNode->GetId(), pGoalNode->GetId(), pGraph->GetVersion() };
+	if (const Entry* const pEntry = Find(key))
+	{
+		path.reserve(pEntry->nodeIds.size());
+		for (int nodeId : pEntry->nodeIds)
+			path.push_back(pGraph->GetNode(nodeId));
+		m_Stats.savedMicroseconds += pEntry->searchMicroseconds - GetMicrosecondsSince(startTime);
+		return path;
+	}
+
+	path = pathfinder.FindPath(pStartNode, pGoalNode);
+
+	Entry entry{ key };
+	entry.hasPath = !path.empty();
+	entry.nodeIds.reserve(path.size());
+	for (const GraphNode* const pNode : path)
+		entry.nodeIds.push_back(pNode->GetId());
+	entry.searchMicroseconds = GetMicrosecondsSince(startTime);
+	Add(std::move(entry));
+	return path;
+}
+
+void PathCache::SetMemoryBudget(size_t memoryBudget)
+{
+	m_MemoryBudget = memoryBudget;
+	EvictToBudget();
+}
+
+void PathCache::Clear()
+{
+	m_Entries.clear();
+	m_EntryLookup.clear();
+	m_MemoryUsage = 0;
+}
+
+const PathCache::Entry* PathCache::Find(const Key& key)
+{
+	auto lookupIt = m_EntryLookup.find(key);
+	if (lookupIt == m_EntryLookup.end())
+	{
+		++m_Stats.nrOfMisses;
+		return nullptr;
+	}
+
+	++m_Stats.nrOfHits;
+	m_Entries.splice(m_Entries.begin(), m_Entries, lookupIt->second);
+	return &m_Entries.front();
+}
+
+void PathCache::Add(Entry&& entry)
+{
+	entry.portalPoints.shrink_to_fit();
+	entry.nodeIds.shrink_to_fit();
+
+	m_MemoryUsage += GetMemorySize(entry);
+	m_Entries.push_front(std::move(entry));
+	m_EntryLookup[m_Entries.front().key] = m_Entries.begin();
+	EvictToBudget();
+}
+
+void PathCache::EvictToBudget()
+{
+	// entries of older graph versions can't be hit anymore, they are the first to go as they stop being used
+	while (m_MemoryUsage > m_MemoryBudget && !m_Entries.empty())
+	{
+		const Entry& oldestEntry = m_Entries.back();
+		m_MemoryUsage -= GetMemorySize(oldestEntry);
+		m_EntryLookup.erase(oldestEntry.key);
+		m_Entries.pop_back();
+		++m_Stats.nrOfEvictions;
+	}
+}
+
+size_t PathCache::GetMemorySize(const Entry& entry)
+{
+	// the list node and the lookup bucket are counted roughly
+	return sizeof(Entry) + 4 * sizeof(void*) + sizeof(Key)
+		+ entry.portalPoints.capacity() * sizeof(Vector2) + entry.nodeIds.capacity() * sizeof(int);
+}
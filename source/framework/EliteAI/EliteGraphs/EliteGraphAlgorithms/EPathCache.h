@@ -0,0 +1,91 @@
+//*=================================================*/
+// EPathCache.h: Least recently used cache in front of the pathfinders, for agents that keep asking for nearly the same path
+// (patrols, chasing a target that stays in the same area). Navmesh paths are keyed on the start and goal triangle,
+// grid paths on the start and goal node, both together with the graph version so an edit never returns an old path.
+// Navmesh entries keep the portals between the triangles, a hit runs the funnel again with the exact start and goal.
+// The oldest entries are evicted once the cache uses more than its memory budget.
+//*=================================================*/
+
+#pragma once
+#include <list>
+#include "EAStar.h"
+#include "EPathSmoothing.h"
+
+namespace Elite
+{
+	class NavGraph;
+
+	struct PathCacheStats
+	{
+		int nrOfHits{ 0 };
+		int nrOfMisses{ 0 };
+		int nrOfEvictions{ 0 };
+		// time the searches of the hits took when they were missed, minus the time the hits took
+		double savedMicroseconds{ 0.0 };
+
+		float GetHitRate() const { return nrOfHits + nrOfMisses > 0 ? static_cast<float>(nrOfHits) / (nrOfHits + nrOfMisses) : 0.f; }
+	};
+
+	class PathCache final
+	{
+	public:
+		static const size_t DEFAULT_MEMORY_BUDGET = 1 << 20;
+
+		explicit PathCache(size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+		// Same result as NavMeshPathfinding::FindPath, except that a start or goal that moved within its triangle reuses the corridor
+		std::vector<Vector2> FindPath(const Vector2& startPos, const Vector2& endPos, NavGraph* const pNavGraph);
+		// Same result as pathfinder.FindPath, pGraph has to be the graph the pathfinder searches
+		std::vector<GraphNode*> FindPath(AStar& pathfinder, Graph* const pGraph, GraphNode* const pStartNode, GraphNode* const pGoalNode);
+
+		// Evicts the oldest entries until the cache fits
+		void SetMemoryBudget(size_t memoryBudget);
+		size_t GetMemoryBudget() const { return m_MemoryBudget; }
+		size_t GetMemoryUsage() const { return m_MemoryUsage; }
+		int GetNrOfEntries() const { return static_cast<int>(m_Entries.size()); }
+		void Clear();
+
+		const PathCacheStats& GetStats() const { return m_Stats; }
+		void ResetStats() { m_Stats = PathCacheStats{}; }
+
+	private:
+		struct Key
+		{
+			const void* pGraph;
+			int startId; // triangle index for navmeshes, node id for other graphs
+			int goalId;
+			unsigned long long version;
+
+			bool operator==(const Key& other) const
+			{ return pGraph == other.pGraph && startId == other.startId && goalId == other.goalId && version == other.version; }
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry
+		{
+			Key key;
+			// navmeshes: left and right point of every portal between the start and goal triangle, other graphs: node ids
+			std::vector<Vector2> portalPoints{};
+			std::vector<int> nodeIds{};
+			bool hasPath{ false };
+			float searchMicroseconds{ 0.f };
+		};
+
+		// Most recently used first
+		std::list<Entry> m_Entries{};
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_EntryLookup{};
+		size_t m_MemoryBudget;
+		size_t m_MemoryUsage{ 0 };
+		PathCacheStats m_Stats{};
+
+		// Moves a hit to the front, nullptr on a miss
+		const Entry* Find(const Key& key);
+		void Add(Entry&& entry);
+		void EvictToBudget();
+		static size_t GetMemorySize(const Entry& entry);
+	};
+}
@@ -0,0 +1,152 @@
+#include "stdafx.h"
+#include "EPathRequestQueue.h"
+#include <chrono>
+
+using namespace Elite;
+
+PathRequestQueue::PathRequestQueue(Graph* const pGraph, Heuristic hFunction)
+	: m_pGraph(pGraph)
+	, m_HeuristicFunction(hFunction)
+	, m_Search(GraphView{ pGraph }, HeuristicPolicies::Runtime{ hFunction })
+{
+}
+
+int PathRequestQueue::RequestPath(int startNodeId, int goalNodeId)
+{
+	int requestId = INVALID_REQUEST_ID;
+	if (!m_FreeRequestIds.empty())
+	{
+		requestId = m_FreeRequestIds.back();
+		m_FreeRequestIds.pop_back();
+	}
+	else
+	{
+		requestId = static_cast<int>(m_Requests.size());
+		m_Requests.emplace_back();
+	}
+
+	Request& request = m_Requests[requestId];
+	request.startNodeId = startNodeId;
+	request.goalNodeId = goalNodeId;
+	request.status = PathRequestStatus::Pending;
+	request.path.clear();
+
+	m_QueuedRequestIds.push_back(requestId);
+	return requestId;
+}
+
+void PathRequestQueue::ReleaseRequest(int requestId)
+{
+	if (!IsValidRequestId(requestId))
+		return;
+
+	auto queuedIt = std::find(m_QueuedRequestIds.begin(), m_QueuedRequestIds.end(), requestId);
+	if (queuedIt != m_QueuedRequestIds.end())
+	{
+		// the search in progress always belongs to the front of the queue
+		if (queuedIt == m_QueuedRequestIds.begin())
+			m_IsSearching = false;
+		m_QueuedRequestIds.erase(queuedIt);
+	}
+
+	Request& request = m_Requests[requestId];
+	request.status = PathRequestStatus::Invalid;
+	request.path.clear();
+	m_FreeRequestIds.push_back(requestId);
+}
+
+void PathRequestQueue::Update(int maxNrOfExpansions, float maxMicroseconds)
+{
+	m_NrOfExpansions = 0;
+	const auto startTime = std::chrono::steady_clock::now();
+
+	while (!m_QueuedRequestIds.empty() && m_NrOfExpansions < maxNrOfExpansions)
+	{
+		Request& request = m_Requests[m_QueuedRequestIds.front()];
+		if (!m_IsSearching || m_SearchGraphVersion != m_pGraph->GetVersion())
+			BeginSearch(request);
+
+		// reading the clock costs more than an expansion, so only do it every 64 expansions
+		const int maxNrOfStepExpansions = maxMicroseconds != FLT_MAX ? std::min(maxNrOfExpansions - m_NrOfExpansions, 64) : maxNrOfExpansions - m_NrOfExpansions;
+		const SearchStatus status = m_Search.Step(m_Context, maxNrOfStepExpansions, m_NrOfExpansions);
+		if (status != SearchStatus::InProgress)
+		{
+			FinishSearch(request, status == SearchStatus::Found ? PathRequestStatus::Done : PathRequestStatus::NoPath);
+			m_IsSearching = false;
+			m_QueuedRequestIds.pop_front();
+		}
+
+		if (maxMicroseconds != FLT_MAX)
+		{
+			const std::chrono::duration<float, std::micro> elapsedTime = std::chrono::steady_clock::now() - startTime;
+			if (elapsedTime.count() >= maxMicroseconds)
+				break;
+		}
+	}
+}
+
+PathRequestStatus PathRequestQueue::GetStatus(int requestId) const
+{
+	return IsValidRequestId(requestId) ? m_Requests[requestId].status : PathRequestStatus::Invalid;
+}
+
+bool PathRequestQueue::GetPath(int requestId, std::vector<int>& path) const
+{
+	path.clear();
+	if (!IsValidRequestId(requestId))
+		return false;
+
+	const Request& request = m_Requests[requestId];
+	if (request.status == PathRequestStatus::Done)
+		path = request.path;
+	else if (request.status == PathRequestStatus::Partial && m_IsSearching && m_QueuedRequestIds.front() == requestId)
+		GetSearchPath(m_Context.GetClosestNodeId(), path);
+	return !path.empty();
+}
+
+bool PathRequestQueue::GetPath(int requestId, std::vector<GraphNode*>& path) const
+{
+	std::vector<int> pathIds{};
+	GetPath(requestId, pathIds);
+
+	path.clear();
+	for (int nodeId : pathIds)
+		path.push_back(m_pGraph->GetNode(nodeId));
+	return !path.empty();
+}
+
+void PathRequestQueue::BeginSearch(Request& request)
+{
+	m_IsSearching = true;
+	m_SearchGraphVersion = m_pGraph->GetVersion();
+	request.status = PathRequestStatus::Partial;
+
+	// a node that got removed leaves the open list empty, so the request ends without a path
+	if (!m_pGraph->IsNodeValid(request.startNodeId) || !m_pGraph->IsNodeValid(request.goalNodeId))
+	{
+		m_Context.BeginSearch(m_pGraph->GetNrOfNodeSlots());
+		return;
+	}
+
+	m_Search = PathSearch{ GraphView{ m_pGraph }, HeuristicPolicies::Runtime{ m_HeuristicFunction } };
+	m_Search.SetLandmarkHeuristic(m_pLandmarks);
+	m_Search.SetHeuristicWeight(m_HeuristicWeight);
+	m_Search.BeginSearch(request.startNodeId, request.goalNodeId, m_Context);
+}
+
+void PathRequestQueue::FinishSearch(Request& request, PathRequestStatus status)
+{
+	request.status = status;
+	if (status == PathRequestStatus::Done)
+		GetSearchPath(request.goalNodeId, request.path);
+	else
+		request.path.clear();
+}
+
+void PathRequestQueue::GetSearchPath(int lastNodeId, std::vector<int>& path) const
+{
+	path.clear();
+	for (int nodeId = lastNodeId; nodeId != invalid_node_id; nodeId = m_Context.GetParent(nodeId))
+		path.push_back(nodeId);
+	std::reverse(path.begin(), path.end());
+}
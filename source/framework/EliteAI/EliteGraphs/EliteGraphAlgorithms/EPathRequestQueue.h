@@ -0,0 +1,84 @@
+//*=================================================*/
+// EPathRequestQueue.h: Path requests that are searched a bit at a time. Update steps the AStarT search of the oldest request
+// for a limited number of expansions (and optionally microseconds) and continues with the next one when it is done,
+// so many agents can ask for paths without one frame taking all the work.
+// Only one search is in progress at a time, so all requests share one SearchContext.
+//*=================================================*/
+
+#pragma once
+#include <deque>
+#include "EAStar.h"
+
+namespace Elite
+{
+	enum class PathRequestStatus
+	{
+		Pending, // waiting for the requests before it
+		Partial, // being searched, the path leads to the node closest to the goal so far
+		Done, // the path reaches the goal
+		NoPath, // searched, the goal can't be reached
+		Invalid // unknown or released request
+	};
+
+	class PathRequestQueue final
+	{
+	public:
+		static constexpr int INVALID_REQUEST_ID = -1;
+
+		PathRequestQueue(Graph* const pGraph, Heuristic hFunction);
+
+		// These are used by the searches that start after them, see AStarT for what they do
+		void SetHeuristicFunction(Heuristic hFunction) { m_HeuristicFunction = hFunction; }
+		void SetLandmarkHeuristic(const LandmarkHeuristic* const pLandmarks) { m_pLandmarks = pLandmarks; }
+		void SetHeuristicWeight(float weight) { assert(weight >= 1.f && "PathRequestQueue: a weight below 1 only slows the search down"); m_HeuristicWeight = weight; }
+
+		// Returns the id to ask the status and path with, release it when the path is no longer needed
+		int RequestPath(int startNodeId, int goalNodeId);
+		// Also cancels the search when it hasn't finished
+		void ReleaseRequest(int requestId);
+
+		// A search that is interrupted by an edit of the graph starts over
+		void Update(int maxNrOfExpansions, float maxMicroseconds = FLT_MAX);
+
+		PathRequestStatus GetStatus(int requestId) const;
+		// Fills in the path for Done and Partial requests, returns false when there is none (yet)
+		bool GetPath(int requestId, std::vector<int>& path) const;
+		bool GetPath(int requestId, std::vector<GraphNode*>& path) const;
+
+		int GetNrOfQueuedRequests() const { return static_cast<int>(m_QueuedRequestIds.size()); }
+		// Expansions done by the last Update
+		int GetNrOfExpansions() const { return m_NrOfExpansions; }
+
+	private:
+		struct Request
+		{
+			int startNodeId{ invalid_node_id };
+			int goalNodeId{ invalid_node_id };
+			PathRequestStatus status{ PathRequestStatus::Invalid };
+			std::vector<int> path{};
+		};
+
+		using PathSearch = AStarT<GraphView, HeuristicPolicies::Runtime>;
+
+		Graph* m_pGraph;
+		Heuristic m_HeuristicFunction;
+		const LandmarkHeuristic* m_pLandmarks{ nullptr };
+		float m_HeuristicWeight{ 1.f };
+
+		std::vector<Request> m_Requests{};
+		std::vector<int> m_FreeRequestIds{};
+		std::deque<int> m_QueuedRequestIds{};
+
+		// search of the request at the front of the queue
+		PathSearch m_Search;
+		SearchContext m_Context{};
+		bool m_IsSearching{ false };
+		unsigned long long m_SearchGraphVersion{ 0 };
+		int m_NrOfExpansions{ 0 };
+
+		void BeginSearch(Request& request);
+		void FinishSearch(Request& request, PathRequestStatus status);
+		void GetSearchPath(int lastNodeId, std::vector<int>& path) const;
+		bool IsValidRequestId(int requestId) const { return requestId >= 0 && requestId < static_cast<int>(m_Requests.size()) && m_Requests[requestId].status != PathRequestStatus::Invalid; }
+	};
+}
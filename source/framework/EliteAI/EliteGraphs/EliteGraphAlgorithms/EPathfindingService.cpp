@@ -0,0 +1,164 @@
+#include "stdafx.h"
+#include "EPathfindingService.h"
+#include <atomic>
+#include "ENavGraphPathfinding.h"
+#include "../EliteNavGraph/ENavGraph.h"
+
+using namespace Elite;
+
+PathfindingService::PathfindingService(int nrOfThreads)
+{
+	if (nrOfThreads <= 0)
+		nrOfThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	m_Workers.reserve(nrOfThreads);
+	for (int threadIdx = 0; threadIdx < nrOfThreads; ++threadIdx)
+		m_Workers.emplace_back(&PathfindingService::RunWorker, this);
+}
+
+PathfindingService::~PathfindingService()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_JobsMutex };
+		m_IsStopping = true;
+	}
+	m_JobAdded.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+std::future<std::vector<std::vector<int>>> PathfindingService::FindPaths(Graph* const pGraph, std::vector<PathQuery> queries, Heuristic hFunction)
+{
+	return FindPaths(pGraph->PublishSnapshot(), std::move(queries), hFunction);
+}
+
+std::future<std::vector<std::vector<int>>> PathfindingService::FindPaths(std::shared_ptr<const CompactGraph> pGraph, std::vector<PathQuery> queries, Heuristic hFunction)
+{
+	struct Batch
+	{
+		std::vector<PathQuery> queries;
+		std::vector<std::vector<int>> paths;
+		std::promise<std::vector<std::vector<int>>> promise{};
+	};
+	auto pBatch = std::make_shared<Batch>();
+	pBatch->queries = std::move(queries);
+	pBatch->paths.resize(pBatch->queries.size());
+	auto result = pBatch->promise.get_future();
+
+	// every query writes its own slot, so the workers never touch the same path
+	RunBatch(static_cast<int>(pBatch->queries.size()),
+		[pBatch, pGraph, hFunction](int queryIdx)
+		{
+			AStar aStar{ pGraph.get(), hFunction };
+			const PathQuery& query = pBatch->queries[queryIdx];
+			aStar.FindPathIds(query.startNodeId, query.goalNodeId, pBatch->paths[queryIdx]);
+		},
+		[pBatch]() { pBatch->promise.set_value(std::move(pBatch->paths)); });
+	return result;
+}
+
+std::future<void> PathfindingService::FindPaths(std::shared_ptr<const CompactGraph> pGraph, std::vector<PathQuery> queries, Heuristic hFunction,
+	std::function<void(int queryIdx, const std::vector<int>& path)> onPathFound)
+{
+	struct Batch
+	{
+		std::vector<PathQuery> queries;
+		std::function<void(int, const std::vector<int>&)> onPathFound;
+		std::promise<void> promise{};
+	};
+	auto pBatch = std::make_shared<Batch>();
+	pBatch->queries = std::move(queries);
+	pBatch->onPathFound = std::move(onPathFound);
+	auto result = pBatch->promise.get_future();
+
+	RunBatch(static_cast<int>(pBatch->queries.size()),
+		[pBatch, pGraph, hFunction](int queryIdx)
+		{
+			// reused for all the queries this worker runs
+			thread_local std::vector<int> path{};
+			AStar aStar{ pGraph.get(), hFunction };
+			const PathQuery& query = pBatch->queries[queryIdx];
+			aStar.FindPathIds(query.startNodeId, query.goalNodeId, path);
+			pBatch->onPathFound(queryIdx, path);
+		},
+		[pBatch]() { pBatch->promise.set_value(); });
+	return result;
+}
+
+std::future<std::vector<std::vector<Vector2>>> PathfindingService::FindPaths(NavGraph* const pNavGraph, std::vector<NavPathQuery> queries)
+{
+	struct Batch
+	{
+		std::vector<NavPathQuery> queries;
+		std::vector<std::vector<Vector2>> paths;
+		std::promise<std::vector<std::vector<Vector2>>> promise{};
+	};
+	auto pBatch = std::make_shared<Batch>();
+	pBatch->queries = std::move(queries);
+	pBatch->paths.resize(pBatch->queries.size());
+	auto result = pBatch->promise.get_future();
+
+	// the start and goal nodes go into an overlay per query, the NavGraph itself is only read
+	RunBatch(static_cast<int>(pBatch->queries.size()),
+		[pBatch, pNavGraph](int queryIdx)
+		{
+			const NavPathQuery& query = pBatch->queries[queryIdx];
+			pBatch->paths[queryIdx] = NavMeshPathfinding::FindPath(query.startPos, query.goalPos, pNavGraph);
+		},
+		[pBatch]() { pBatch->promise.set_value(std::move(pBatch->paths)); });
+	return result;
+}
+
+void PathfindingService::RunBatch(int nrOfQueries, std::function<void(int)> runQuery, std::function<void()> onBatchDone)
+{
+	if (nrOfQueries == 0)
+	{
+		onBatchDone();
+		return;
+	}
+
+	struct BatchProgress
+	{
+		std::atomic<int> nextQueryIdx{ 0 };
+		std::atomic<int> nrOfRunningJobs{ 0 };
+	};
+	auto pProgress = std::make_shared<BatchProgress>();
+
+	// one job per worker that takes queries until there are none left, a small batch doesn't need all workers
+	const int nrOfJobs = std::min(nrOfQueries, GetNrOfThreads());
+	pProgress->nrOfRunningJobs = nrOfJobs;
+	{
+		std::lock_guard<std::mutex> lock{ m_JobsMutex };
+		for (int jobIdx = 0; jobIdx < nrOfJobs; ++jobIdx)
+		{
+			m_Jobs.emplace_back([pProgress, nrOfQueries, runQuery, onBatchDone]()
+				{
+					for (int queryIdx = pProgress->nextQueryIdx++; queryIdx < nrOfQueries; queryIdx = pProgress->nextQueryIdx++)
+						runQuery(queryIdx);
+
+					if (--pProgress->nrOfRunningJobs == 0)
+						onBatchDone();
+				});
+		}
+	}
+	m_JobAdded.notify_all();
+}
+
+void PathfindingService::RunWorker()
+{
+	while (true)
+	{
+		std::function<void()> job{};
+		{
+			std::unique_lock<std::mutex> lock{ m_JobsMutex };
+			m_JobAdded.wait(lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+			if (m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+		job();
+	}
+}
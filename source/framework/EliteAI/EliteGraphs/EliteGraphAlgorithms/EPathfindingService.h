@@ -0,0 +1,66 @@
+//*=================================================*/
+// EPathfindingService.h: Runs batches of path queries on a pool of worker threads.
+// Graphs are searched through their published snapshot, so the game thread can keep editing the graph
+// while a batch runs. Every worker searches with its own thread context, the queries of a batch are handed out
+// one at a time so slow queries don't leave the other workers idle.
+//*=================================================*/
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "EAStar.h"
+
+namespace Elite
+{
+	class NavGraph;
+
+	struct PathQuery
+	{
+		int startNodeId{ invalid_node_id };
+		int goalNodeId{ invalid_node_id };
+	};
+
+	struct NavPathQuery
+	{
+		Vector2 startPos{};
+		Vector2 goalPos{};
+	};
+
+	class PathfindingService final
+	{
+	public:
+		// 0 starts a worker for every hardware thread
+		explicit PathfindingService(int nrOfThreads = 0);
+		// Finishes the batches that are still queued
+		~PathfindingService();
+
+		int GetNrOfThreads() const { return static_cast<int>(m_Workers.size()); }
+
+		// Publishes a snapshot of the graph, so call it from the thread that edits the graph. Paths are node ids,
+		// in the same order as the queries and empty when there is none
+		std::future<std::vector<std::vector<int>>> FindPaths(Graph* const pGraph, std::vector<PathQuery> queries, Heuristic hFunction);
+		std::future<std::vector<std::vector<int>>> FindPaths(std::shared_ptr<const CompactGraph> pGraph, std::vector<PathQuery> queries, Heuristic hFunction);
+		// onPathFound gets called on a worker thread as soon as the path of a query is found, the future is ready after the last one
+		std::future<void> FindPaths(std::shared_ptr<const CompactGraph> pGraph, std::vector<PathQuery> queries, Heuristic hFunction,
+			std::function<void(int queryIdx, const std::vector<int>& path)> onPathFound);
+		// Smoothed paths through the navigation mesh. The workers read the NavGraph itself, it must not change until the future is ready
+		std::future<std::vector<std::vector<Vector2>>> FindPaths(NavGraph* const pNavGraph, std::vector<NavPathQuery> queries);
+
+	private:
+		// Calls runQuery(queryIdx) for every query spread over the workers, then onBatchDone on the worker that finished last
+		void RunBatch(int nrOfQueries, std::function<void(int)> runQuery, std::function<void()> onBatchDone);
+		void RunWorker();
+
+		std::vector<std::thread> m_Workers{};
+		std::deque<std::function<void()>> m_Jobs{};
+		std::mutex m_JobsMutex{};
+		std::condition_variable m_JobAdded{};
+		bool m_IsStopping{ false };
+
+		PathfindingService(const PathfindingService& other) = delete;
+		PathfindingService& operator=(const PathfindingService& other) = delete;
+	};
+}
@@ -0,0 +1,41 @@
+#include "stdafx.h"
+#include "ESearchContext.h"
+
+using namespace Elite;
+
+void SearchContext::BeginSearch(int nrOfNodeSlots)
+{
+	if (static_cast<int>(m_Records.size()) < nrOfNodeSlots)
+		m_Records.resize(nrOfNodeSlots, Record{ FLT_MAX, invalid_node_id, 0 });
+
+	// after a wrap around, old records could have the new generation so they have to be cleared once
+	if (++m_Generation == 0)
+	{
+		for (Record& record : m_Records)
+			record.generation = 0;
+		m_Generation = 1;
+	}
+
+	m_OpenList.Clear();
+	if (m_OpenList.GetNrOfIds() < nrOfNodeSlots)
+		m_OpenList.Resize(nrOfNodeSlots);
+
+	m_GoalNodeId = invalid_node_id;
+	m_ClosestNodeId = invalid_node_id;
+	m_ClosestHeuristicCost = FLT_MAX;
+
+	m_Queue.clear();
+	m_QueueHead = 0;
+}
+
+SearchContext& SearchContext::GetThreadContext()
+{
+	thread_local SearchContext context{};
+	return context;
+}
+
+SearchContext& SearchContext::GetThreadBackwardContext()
+{
+	thread_local SearchContext context{};
+	return context;
+}
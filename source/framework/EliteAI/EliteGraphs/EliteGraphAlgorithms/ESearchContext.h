@@ -0,0 +1,73 @@
+//*=================================================*/
+// ESearchContext.h: Scratch memory of a graph search (cost, parent and open list per node id) that is kept between queries.
+// Starting a search bumps a generation counter instead of clearing the arrays, records of older searches count as unreached.
+//*=================================================*/
+
+#pragma once
+#include "../EliteGraph/EGraphEnums.h"
+#include "EIndexedPriorityQueue.h"
+
+namespace Elite
+{
+	class SearchContext final
+	{
+	public:
+		SearchContext() = default;
+
+		// Starts a new search over the node ids [0, nrOfNodeSlots), only allocates when there are more slots than before
+		void BeginSearch(int nrOfNodeSlots);
+
+		//Per node records of the current search
+		bool IsReached(int nodeId) const { return m_Records[nodeId].generation == m_Generation; }
+		float GetCostSoFar(int nodeId) const { return IsReached(nodeId) ? m_Records[nodeId].costSoFar : FLT_MAX; }
+		int GetParent(int nodeId) const { return IsReached(nodeId) ? m_Records[nodeId].parentNodeId : invalid_node_id; }
+		void SetReached(int nodeId, float costSoFar, int parentNodeId) { m_Records[nodeId] = Record{ costSoFar, parentNodeId, m_Generation }; }
+
+		//Open list for best-first searches
+		IndexedPriorityQueue& GetOpenList() { return m_OpenList; }
+
+		//Goal of a best-first search that is continued in steps, and the reached node estimated closest to it (where a partial path leads)
+		int GetGoalNodeId() const { return m_GoalNodeId; }
+		void SetGoalNodeId(int goalNodeId) { m_GoalNodeId = goalNodeId; }
+		int GetClosestNodeId() const { return m_ClosestNodeId; }
+		void UpdateClosestNode(int nodeId, float heuristicCost)
+		{
+			if (heuristicCost >= m_ClosestHeuristicCost)
+				return;
+			m_ClosestNodeId = nodeId;
+			m_ClosestHeuristicCost = heuristicCost;
+		}
+
+		//First in, first out queue for breadth-first searches
+		bool IsQueueEmpty() const { return m_QueueHead == m_Queue.size(); }
+		void PushQueue(int nodeId) { m_Queue.push_back(nodeId); }
+		int PopQueue() { return m_Queue[m_QueueHead++]; }
+		int GetQueueSize() const { return static_cast<int>(m_Queue.size() - m_QueueHead); }
+
+		// Context of the calling thread for searches that weren't given one, a nested search needs a context of its own
+		static SearchContext& GetThreadContext();
+		// Second context of the calling thread, for the backward half of bidirectional searches
+		static SearchContext& GetThreadBackwardContext();
+
+	private:
+		struct Record
+		{
+			float costSoFar;
+			int parentNodeId;
+			unsigned int generation;
+		};
+
+		std::vector<Record> m_Records{};
+		unsigned int m_Generation{ 0 };
+
+		IndexedPriorityQueue m_OpenList{};
+		int m_GoalNodeId{ invalid_node_id };
+		int m_ClosestNodeId{ invalid_node_id };
+		float m_ClosestHeuristicCost{ FLT_MAX };
+		std::vector<int> m_Queue{};
+		size_t m_QueueHead{ 0 };
+
+		SearchContext(const SearchContext& other) = delete;
+		SearchContext& operator=(const SearchContext& other) = delete;
+	};
+}
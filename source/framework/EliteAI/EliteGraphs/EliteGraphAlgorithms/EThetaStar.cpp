@@ -0,0 +1,231 @@
+#include "stdafx.h"
+#include "EThetaStar.h"
+
+using namespace Elite;
+
+ThetaStar::ThetaStar(GridGraph* const pGrid, bool isLazy)
+	: m_pGrid(pGrid)
+	, m_IsLazy(isLazy)
+{
+	assert(!pGrid->IsDirectional() && "ThetaStar: lines of sight are walked both ways, the grid has to be undirected");
+}
+
+std::vector<GraphNode*> ThetaStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode)
+{
+	std::vector<GraphNode*> path{};
+	FindPath(pStartNode, pGoalNode, path);
+	return path;
+}
+
+std::vector<int> ThetaStar::FindPathIds(int startNodeId, int goalNodeId)
+{
+	std::vector<int> path{};
+	FindPathIds(startNodeId, goalNodeId, path);
+	return path;
+}
+
+void ThetaStar::FindPath(GraphNode* const pStartNode, GraphNode* const pGoalNode, std::vector<GraphNode*>& path)
+{
+	FindPathIds(pStartNode->GetId(), pGoalNode->GetId(), m_PathIds);
+
+	path.clear();
+	for (int nodeId : m_PathIds)
+		path.push_back(m_pGrid->GetNode(nodeId));
+}
+
+void ThetaStar::FindPathIds(int startNodeId, int goalNodeId, std::vector<int>& path)
+{
+	path.clear();
+	Prepare();
+
+	SearchContext& context = m_pSearchContext != nullptr ? *m_pSearchContext : SearchContext::GetThreadContext();
+	if (!Search(startNodeId, goalNodeId, context))
+		return;
+
+	// the parents are the corners of the path
+	for (int nodeId = goalNodeId; nodeId != invalid_node_id; nodeId = context.GetParent(nodeId))
+		path.push_back(nodeId);
+	std::reverse(path.begin(), path.end());
+}
+
+bool ThetaStar::HasLineOfSight(int fromNodeId, int toNodeId)
+{
+	Prepare();
+	float cost{};
+	return HasLineOfSight(fromNodeId, toNodeId, cost);
+}
+
+void ThetaStar::Prepare()
+{
+	const unsigned long long version = m_pGrid->GetVersion();
+	if (m_IsPrepared && version == m_PreparedVersion)
+		return;
+
+	m_IsPrepared = true;
+	m_PreparedVersion = version;
+
+	const int nrOfCells = m_pGrid->GetRows() * m_pGrid->GetColumns();
+	m_CellCosts.assign(nrOfCells, FLT_MAX);
+	m_MinCostPerCell = FLT_MAX;
+	for (int nodeId = 0; nodeId < nrOfCells; ++nodeId)
+	{
+		if (!m_pGrid->IsNodeValid(nodeId))
+			continue;
+
+		const auto [row, col] = m_pGrid->GetRowAndColumn(nodeId);
+		for (const GraphConnection* const pConnection : m_pGrid->GetConnectionsFromNode(nodeId))
+		{
+			const auto [toRow, toCol] = m_pGrid->GetRowAndColumn(pConnection->GetToNodeId());
+			const int dx = toCol - col;
+			const int dy = toRow - row;
+			if (abs(dx) + abs(dy) == 1)
+				m_CellCosts[nodeId] = std::min(m_CellCosts[nodeId], pConnection->GetCost());
+			m_MinCostPerCell = std::min(m_MinCostPerCell, pConnection->GetCost() / sqrtf(static_cast<float>(dx * dx + dy * dy)));
+		}
+	}
+
+	if (m_MinCostPerCell == FLT_MAX)
+		m_MinCostPerCell = 0.f;
+}
+
+bool ThetaStar::Search(int startNodeId, int goalNodeId, SearchContext& context)
+{
+	m_NrOfExpandedNodes = 0;
+	m_NrOfLineOfSightChecks = 0;
+
+	context.BeginSearch(m_pGrid->GetNrOfNodeSlots());
+	IndexedPriorityQueue& openNodes = context.GetOpenList();
+
+	context.SetReached(startNodeId, 0.f, invalid_node_id);
+	openNodes.Push(startNodeId, GetHeuristicCost(startNodeId, goalNodeId));
+
+	while (!openNodes.IsEmpty())
+	{
+		const int currentNodeId = openNodes.Pop();
+		if (m_IsLazy)
+			UpdateParent(currentNodeId, context);
+		if (currentNodeId == goalNodeId)
+			return true;
+
+		++m_NrOfExpandedNodes;
+		const float currentCostSoFar = context.GetCostSoFar(currentNodeId);
+		const int parentNodeId = context.GetParent(currentNodeId);
+		for (const GraphConnection* const pConnection : m_pGrid->GetConnectionsFromNode(currentNodeId))
+		{
+			const int nextNodeId = pConnection->GetToNodeId();
+			if (IsClosed(nextNodeId, context))
+				continue;
+
+			// straight from the parent when it can see the next node, Lazy Theta* assumes it can and checks when it is expanded
+			int nextParentNodeId = currentNodeId;
+			float gCost = currentCostSoFar + pConnection->GetCost();
+			if (parentNodeId != invalid_node_id && m_CellCosts[parentNodeId] != FLT_MAX)
+			{
+				float lineCost = m_CellCosts[parentNodeId] * GetDistance(parentNodeId, nextNodeId);
+				if (m_IsLazy || HasLineOfSight(parentNodeId, nextNodeId, lineCost))
+				{
+					nextParentNodeId = parentNodeId;
+					gCost = context.GetCostSoFar(parentNodeId) + lineCost;
+				}
+			}
+
+			if (gCost >= context.GetCostSoFar(nextNodeId))
+				continue;
+
+			context.SetReached(nextNodeId, gCost, nextParentNodeId);
+			openNodes.Push(nextNodeId, gCost + GetHeuristicCost(nextNodeId, goalNodeId));
+		}
+	}
+
+	return false;
+}
+
+// Lazy Theta*: without a line of sight to the assumed parent, the node is reached from its cheapest expanded neighbour instead
+void ThetaStar::UpdateParent(int nodeId, SearchContext& context)
+{
+	const int parentNodeId = context.GetParent(nodeId);
+	float lineCost{};
+	if (parentNodeId == invalid_node_id || HasLineOfSight(parentNodeId, nodeId, lineCost))
+		return;
+
+	float bestCost = FLT_MAX;
+	int bestParentNodeId = invalid_node_id;
+	for (const GraphConnection* const pConnection : m_pGrid->GetConnectionsFromNode(nodeId))
+	{
+		const int neighborNodeId = pConnection->GetToNodeId();
+		if (!IsClosed(neighborNodeId, context))
+			continue;
+
+		const float cost = context.GetCostSoFar(neighborNodeId) + pConnection->GetCost();
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestParentNodeId = neighborNodeId;
+		}
+	}
+
+	// the node that opened this one is expanded, so there is always a neighbour
+	context.SetReached(nodeId, bestCost, bestParentNodeId);
+}
+
+// Walks every cell the line between both cell centres touches. A line through a corner touches the cells on both sides
+bool ThetaStar::HasLineOfSight(int fromNodeId, int toNodeId, float& cost)
+{
+	++m_NrOfLineOfSightChecks;
+
+	const float cellCost = m_CellCosts[fromNodeId];
+	if (cellCost == FLT_MAX)
+		return false;
+
+	const auto [fromRow, fromCol] = m_pGrid->GetRowAndColumn(fromNodeId);
+	const auto [toRow, toCol] = m_pGrid->GetRowAndColumn(toNodeId);
+	const int stepX = toCol > fromCol ? 1 : -1;
+	const int stepY = toRow > fromRow ? 1 : -1;
+	const int dx = abs(toCol - fromCol);
+	const int dy = abs(toRow - fromRow);
+
+	// the sign of error tells whether the line leaves the cell through its vertical or its horizontal edge
+	int col = fromCol;
+	int row = fromRow;
+	int error = dx - dy;
+	for (int nrOfSteps = dx + dy; nrOfSteps > 0; --nrOfSteps)
+	{
+		if (error > 0)
+		{
+			col += stepX;
+			error -= 2 * dy;
+		}
+		else if (error < 0)
+		{
+			row += stepY;
+			error += 2 * dx;
+		}
+		else
+		{
+			// through a corner, the cells on both sides of it have to be open as well
+			if (m_CellCosts[m_pGrid->GetNodeId(col + stepX, row)] != cellCost || m_CellCosts[m_pGrid->GetNodeId(col, row + stepY)] != cellCost)
+				return false;
+
+			col += stepX;
+			row += stepY;
+			error += 2 * dx - 2 * dy;
+			--nrOfSteps;
+		}
+
+		if (m_CellCosts[m_pGrid->GetNodeId(col, row)] != cellCost)
+			return false;
+	}
+
+	cost = cellCost * GetDistance(fromNodeId, toNodeId);
+	return true;
+}
+
+// In cells
+float ThetaStar::GetDistance(int fromNodeId, int toNodeId) const
+{
+	const auto [fromRow, fromCol] = m_pGrid->GetRowAndColumn(fromNodeId);
+	const auto [toRow, toCol] = m_pGrid->GetRowAndColumn(toNodeId);
+	const float dx = static_cast<float>(toCol - fromCol);
+	const float dy = static_cast<float>(toRow - fromRow);
+	return sqrtf(dx * dx + dy * dy);
+}
@@ -0,0 +1,62 @@
+//*=================================================*/
+// EThetaStar.h: Any-angle paths on a GridGraph (Theta*). Like A*, but a node can take the parent of the node it was
+// reached from as its own parent when there is a line of sight between them, so the path only has waypoints at corners.
+// Lazy Theta* assumes the line of sight and only checks it when the node is expanded, which takes far fewer checks.
+// Cells without connections are blocked. Lines of sight only cross open cells with the same cost and cost the length
+// of the line times that cost, the cost of a cell is its cheapest straight connection. Lines through the corner of a
+// blocked cell are blocked, so agents don't cut corners.
+//*=================================================*/
+
+#pragma once
+#include "EAStar.h"
+#include "../EliteGridGraph/EGridGraph.h"
+
+namespace Elite
+{
+	class ThetaStar final
+	{
+	public:
+		// The grid has to be undirected, lines of sight are walked both ways
+		explicit ThetaStar(GridGraph* const pGrid, bool isLazy = true);
+
+		// Scratch memory for the searches, uses the context of the calling thread when none is set
+		void SetSearchContext(SearchContext* const pContext) { m_pSearchContext = pContext; }
+
+		// The path only has the start, the goal and the corners in between
+		std::vector<GraphNode*> FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode);
+		std::vector<int> FindPathIds(int startNodeId, int destinationNodeId);
+		void FindPath(GraphNode* const pStartNode, GraphNode* const pDestinationNode, std::vector<GraphNode*>& path);
+		void FindPathIds(int startNodeId, int destinationNodeId, std::vector<int>& path);
+
+		// True if the straight line between the centres of both cells only crosses open cells with the same cost
+		bool HasLineOfSight(int fromNodeId, int toNodeId);
+
+		// Nodes taken from the open list and lines of sight checked during the last search
+		int GetNrOfExpandedNodes() const { return m_NrOfExpandedNodes; }
+		int GetNrOfLineOfSightChecks() const { return m_NrOfLineOfSightChecks; }
+
+	private:
+		GridGraph* m_pGrid;
+		bool m_IsLazy;
+		SearchContext* m_pSearchContext = nullptr;
+
+		// Derived from the grid and rebuilt when its version changes
+		bool m_IsPrepared{ false };
+		unsigned long long m_PreparedVersion{ 0 };
+		std::vector<float> m_CellCosts{}; // FLT_MAX for blocked cells
+		float m_MinCostPerCell{ 0.f }; // lowest cost of a connection divided by its length, keeps the estimates below the real costs
+
+		int m_NrOfExpandedNodes{ 0 };
+		int m_NrOfLineOfSightChecks{ 0 };
+		std::vector<int> m_PathIds{};
+
+		void Prepare();
+		bool Search(int startNodeId, int goalNodeId, SearchContext& context);
+		void UpdateParent(int nodeId, SearchContext& context);
+		bool IsClosed(int nodeId, SearchContext& context) const { return context.IsReached(nodeId) && !context.GetOpenList().Contains(nodeId); }
+
+		bool HasLineOfSight(int fromNodeId, int toNodeId, float& cost);
+		float GetDistance(int fromNodeId, int toNodeId) const;
+		float GetHeuristicCost(int nodeId, int goalNodeId) const { return m_MinCostPerCell * GetDistance(nodeId, goalNodeId); }
+	};
+}
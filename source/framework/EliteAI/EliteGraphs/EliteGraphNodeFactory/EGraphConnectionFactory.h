@@ -0,0 +1,39 @@
+#pragma once
+#include "../EliteGraph/EGraphConnection.h"
+#include "framework/EliteHelpers/EObjectPool.h"
+
+namespace Elite
+{
+	class GraphConnectionFactory
+	{
+	public:
+		GraphConnectionFactory() = default;
+		virtual ~GraphConnectionFactory() = default;
+
+		virtual GraphConnection* const CreateConnection(int fromId, int toId, float cost, const Color& color) const { return new GraphConnection(fromId, toId, cost, color); }
+		virtual GraphConnection* const CloneConnection(const GraphConnection& other) const { return new GraphConnection(other); }
+		virtual void DestroyConnection(GraphConnection* const pConnection) const { delete pConnection; }
+	};
+
+	// Allocates the connections in slabs owned by the factory instead of one heap allocation per connection.
+	// Connections that were not created by this factory (e.g. AddConnection(new GraphConnection(...))) are still deleted normally.
+	class PooledGraphConnectionFactory final : public GraphConnectionFactory
+	{
+	public:
+		PooledGraphConnectionFactory() = default;
+		virtual ~PooledGraphConnectionFactory() = default;
+
+		GraphConnection* const CreateConnection(int fromId, int toId, float cost, const Color& color) const override { return m_Pool.Create(fromId, toId, cost, color); }
+		GraphConnection* const CloneConnection(const GraphConnection& other) const override { return m_Pool.Create(other); }
+		void DestroyConnection(GraphConnection* const pConnection) const override
+		{
+			if (m_Pool.Owns(pConnection))
+				m_Pool.Destroy(pConnection);
+			else
+				delete pConnection;
+		}
+
+	private:
+		mutable EObjectPool<GraphConnection> m_Pool{};
+	};
+}
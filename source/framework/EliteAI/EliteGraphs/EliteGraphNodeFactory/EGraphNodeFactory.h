@@ -1,6 +1,7 @@
 #pragma once
 #include <concepts>
 #include "../EliteGraph/EGraphNode.h"
+#include "framework/EliteHelpers/EObjectPool.h"
 
 namespace Elite
 {
@@ -19,6 +20,7 @@ namespace Elite
 
 		virtual GraphNode* const CreateNode(const Elite::Vector2& pos) const = 0;
 		virtual GraphNode* const CloneNode(const GraphNode& other) const = 0;
+		virtual void DestroyNode(GraphNode* const pNode) const { delete pNode; }
 	};
 
 	template<graphnodetype T_GraphNode>
@@ -31,4 +33,27 @@ namespace Elite
 		GraphNode* const CreateNode(const Elite::Vector2& pos) const  override { return new T_GraphNode(pos); }
 		GraphNode* const CloneNode(const GraphNode& other) const  override { return  new T_GraphNode((const T_GraphNode&)other); }
 	};
+
+	// Allocates the nodes in slabs owned by the factory instead of one heap allocation per node.
+	// Nodes that were not created by this factory (e.g. AddNode(new GraphNode(...))) are still deleted normally.
+	template<graphnodetype T_GraphNode>
+	class PooledGraphNodeFactory : public GraphNodeFactory
+	{
+	public:
+		PooledGraphNodeFactory() = default;
+		virtual ~PooledGraphNodeFactory() = default;
+
+		GraphNode* const CreateNode(const Elite::Vector2& pos) const override { return m_Pool.Create(pos); }
+		GraphNode* const CloneNode(const GraphNode& other) const override { return m_Pool.Create((const T_GraphNode&)other); }
+		void DestroyNode(GraphNode* const pNode) const override
+		{
+			if (m_Pool.Owns(pNode))
+				m_Pool.Destroy(static_cast<T_GraphNode*>(pNode));
+			else
+				delete pNode;
+		}
+
+	private:
+		mutable EObjectPool<T_GraphNode> m_Pool{};
+	};
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "stdafx.h"
+#include "EGraphBenchmark.h"
+#include "../EliteGraph/EGraphConnection.h"
+#include "../EliteGridGraph/EGridGraph.h"
+#include "../EliteTerrainGridGraph/ETerrainGridGraph.h"
+#include "../EliteTerrainGridGraph/ETerrainGraphNode.h"
+#include "../EliteGraphAlgorithms/EAStar.h"
+#include "../EliteGraphAlgorithms/EHeuristicFunctions.h"
+
+using namespace Elite;
+
+namespace
+{
+	float GetMilliseconds(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	float GetPathCost(const Graph& graph, const std::vector<GraphNode*>& path)
+	{
+		float cost{ 0.f };
+		for (size_t i = 1; i < path.size(); ++i)
+			cost += graph.GetConnection(path[i - 1]->GetId(), path[i]->GetId())->GetCost();
+		return cost;
+	}
+
+	struct ReferenceNodeRecord final
+	{
+		GraphNode* pNode = nullptr;
+		GraphConnection* pConnection = nullptr;
+		float costSoFar = 0.f;
+		float estimatedTotalCost = 0.f;
+	};
+
+	// AStar::FindPath as it was before the indexed open list, kept to compare against.
+	// Quadratic in the visited nodes, on the 1000x1000 grid it runs for minutes
+	std::vector<GraphNode*> FindReferencePath(Graph& graph, GraphNode* const pStartNode, GraphNode* const pGoalNode, Heuristic hFunction)
+	{
+		auto getHeuristicCost = [&](GraphNode* const pNode)
+			{
+				const Vector2 toDestination = pGoalNode->GetPosition() - pNode->GetPosition();
+				return hFunction(abs(toDestination.x), abs(toDestination.y));
+			};
+
+		std::vector<GraphNode*> path{};
+		std::vector<ReferenceNodeRecord> openNodes{ { pStartNode, nullptr, 0.f, getHeuristicCost(pStartNode) } };
+		std::vector<ReferenceNodeRecord> closedNodes{};
+
+		while (!openNodes.empty())
+		{
+			auto currentIt = std::min_element(openNodes.begin(), openNodes.end(),
+				[](const ReferenceNodeRecord& a, const ReferenceNodeRecord& b)
+				{
+					return a.estimatedTotalCost < b.estimatedTotalCost;
+				});
+			ReferenceNodeRecord currentNode = *currentIt;
+
+			if (currentNode.pNode == pGoalNode)
+			{
+				while (currentNode.pConnection != nullptr)
+				{
+					path.push_back(currentNode.pNode);
+					GraphNode* const pFromNode = graph.GetNode(currentNode.pConnection->GetFromNodeId());
+					currentNode = *std::find_if(closedNodes.begin(), closedNodes.end(), [&](const ReferenceNodeRecord& record) { return record.pNode == pFromNode; });
+				}
+
+				path.push_back(pStartNode);
+				std::reverse(path.begin(), path.end());
+				return path;
+			}
+
+			openNodes.erase(currentIt);
+			closedNodes.push_back(currentNode);
+
+			for (GraphConnection* const pConnection : graph.GetConnectionsFromNode(currentNode.pNode->GetId()))
+			{
+				GraphNode* const pToNode = graph.GetNode(pConnection->GetToNodeId());
+				const float gCost = currentNode.costSoFar + pConnection->GetCost();
+
+				auto closedIt = std::find_if(closedNodes.begin(), closedNodes.end(), [&](const ReferenceNodeRecord& record) { return record.pNode == pToNode; });
+				if (closedIt != closedNodes.end())
+				{
+					if (gCost >= closedIt->costSoFar)
+						continue;
+					closedNodes.erase(closedIt);
+				}
+
+				auto openIt = std::find_if(openNodes.begin(), openNodes.end(), [&](const ReferenceNodeRecord& record) { return record.pNode == pToNode; });
+				if (openIt != openNodes.end())
+				{
+					if (gCost >= openIt->costSoFar)
+						continue;
+					openNodes.erase(openIt);
+				}
+
+				openNodes.push_back({ pToNode, pConnection, gCost, gCost + getHeuristicCost(pToNode) });
+			}
+		}
+
+		return path;
+	}
+}
+
+AStarBenchmarkResult GraphBenchmark::BenchmarkAStar(int size, bool runReference)
+{
+	AStarBenchmarkResult result{};
+	result.size = size;
+
+	auto startTime = std::chrono::steady_clock::now();
+	TerrainGridGraph graph{ size, size, 5, false, true, 5.f, 7.f };
+
+	std::mt19937 random{ 1 };
+	const int nrOfCells = size * size;
+	graph.BeginEdit();
+	for (int i = 0; i < nrOfCells / 10; ++i)
+	{
+		const int nodeId = static_cast<int>(random() % nrOfCells);
+		if (nodeId == 0 || nodeId == nrOfCells - 1)
+			continue;
+
+		graph.RemoveAllConnectionsWithNode(nodeId);
+		if (random() % 3 == 0)
+		{
+			graph.SetNodeTerrainType(nodeId, TerrainType::Water);
+		}
+		else
+		{
+			graph.SetNodeTerrainType(nodeId, TerrainType::Mud);
+			graph.AddConnectionsToAdjacentCells(nodeId);
+		}
+	}
+
+	// the gap is in the last row, the goal corner
+	for (int row = 0; row < size - 1; ++row)
+	{
+		const int nodeId = graph.GetNodeId(size / 2, row);
+		graph.SetNodeTerrainType(nodeId, TerrainType::Water);
+		graph.RemoveAllConnectionsWithNode(nodeId);
+	}
+	graph.EndEdit();
+	result.buildMilliseconds = GetMilliseconds(startTime);
+
+	GraphNode* const pStartNode = graph.GetNode(0);
+	GraphNode* const pGoalNode = graph.GetNode(nrOfCells - 1);
+
+	AStar pathfinder{ &graph, HeuristicFunctions::Octile };
+	startTime = std::chrono::steady_clock::now();
+	const std::vector<GraphNode*> path = pathfinder.FindPath(pStartNode, pGoalNode);
+	result.searchMilliseconds = GetMilliseconds(startTime);
+	result.pathLength = static_cast<int>(path.size());
+
+	if (runReference)
+	{
+		startTime = std::chrono::steady_clock::now();
+		const std::vector<GraphNode*> referencePath = FindReferencePath(graph, pStartNode, pGoalNode, HeuristicFunctions::Octile);
+		result.referenceMilliseconds = GetMilliseconds(startTime);
+		result.isSamePathCost = abs(GetPathCost(graph, path) - GetPathCost(graph, referencePath)) <= 0.001f * GetPathCost(graph, referencePath);
+	}
+
+	return result;
+}
+
+GridConstructionBenchmarkResult GraphBenchmark::BenchmarkGridConstruction(int size)
+{
+	GridConstructionBenchmarkResult result{};
+	result.size = size;
+
+	// the destructor is not part of the construction
+	const auto startTime = std::chrono::steady_clock::now();
+	const GridGraph* const pGraph = new GridGraph(size, size, 5, false, true);
+	result.milliseconds = GetMilliseconds(startTime);
+	result.nanosecondsPerNode = result.milliseconds * 1000000.f / pGraph->GetAmountOfNodes();
+	delete pGraph;
+
+	return result;
+}
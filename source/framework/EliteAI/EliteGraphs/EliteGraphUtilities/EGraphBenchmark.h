@@ -0,0 +1,46 @@
+//*=================================================*/
+// EGraphBenchmark.h: Timings for the graph code on large grids, so the speedups can be reproduced in every build.
+// The search grids are the same on every run: random mud and water on 10% of the cells and a wall with a gap at the far end,
+// so a search from corner to corner visits about half of the grid. Run from App_PathfindingAStar.
+//*=================================================*/
+
+#pragma once
+
+namespace Elite
+{
+	struct AStarBenchmarkResult
+	{
+		int size{ 0 };
+		float buildMilliseconds{ 0.f };
+		float searchMilliseconds{ 0.f };
+		// -1 when the reference search was skipped
+		float referenceMilliseconds{ -1.f };
+		int pathLength{ 0 };
+		bool isSamePathCost{ true };
+	};
+
+	struct GridConstructionBenchmarkResult
+	{
+		int size{ 0 };
+		float milliseconds{ 0.f };
+		// stays about the same for every size when the construction is linear in the number of nodes
+		float nanosecondsPerNode{ 0.f };
+	};
+
+	class GraphBenchmark final
+	{
+	public:
+		static constexpr int SIZES[] = { 100, 500, 1000 };
+
+		// Times AStar::FindPath from corner to corner on a size x size TerrainGridGraph with diagonals and the Octile heuristic.
+		// The reference is the search AStar used before it had an indexed open list (min_element over the open list, find_if over
+		// both lists), its time grows with the square of the visited nodes so only run it on the small grids
+		static AStarBenchmarkResult BenchmarkAStar(int size, bool runReference);
+		// Times the constructor of a size x size GridGraph with diagonals, adding every node and its connections.
+		// The time per node is reported so the sizes can be compared, it grows with the size when the construction is not linear
+		static GridConstructionBenchmarkResult BenchmarkGridConstruction(int size);
+
+	private:
+		GraphBenchmark() = delete;
+	};
+}
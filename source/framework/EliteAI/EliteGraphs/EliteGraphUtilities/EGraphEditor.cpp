@@ -109,7 +109,7 @@ bool GraphEditor::UpdateGraph(Graph* const pGraph)
 			DEBUGRENDERER2D->DrawCircle(nodePos, DEFAULT_NODE_RADIUS, { 1,1,1 }, -1);
 			if (m_mouseHasMoved)
 			{
-				pGraph->GetNode(m_SelectedNodeIdx)->SetPosition(m_MousePos);
+				pGraph->SetNodePosition(m_SelectedNodeIdx, m_MousePos);
 			}
 			hasGraphChanged = true;
 		}
@@ -196,6 +196,7 @@ bool GraphEditor::UpdateGraph(TerrainGridGraph* pGraph)
 		{
 			std::vector<TerrainType> terrainTypeVec{ TerrainType::Ground, TerrainType::Mud, TerrainType::Water };
 
+			pGraph->BeginEdit();
 			pGraph->SetNodeTerrainType(idx, terrainTypeVec[m_SelectedTerrainType]);
 			switch (terrainTypeVec[m_SelectedTerrainType])
 			{
@@ -207,6 +208,7 @@ bool GraphEditor::UpdateGraph(TerrainGridGraph* pGraph)
 				pGraph->AddConnectionsToAdjacentCells(idx);
 				break;
 			}
+			pGraph->EndEdit();
 			return true;
 		}
 	}
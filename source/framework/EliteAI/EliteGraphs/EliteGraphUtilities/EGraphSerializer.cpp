@@ -0,0 +1,461 @@
+#include "stdafx.h"
+#include "EGraphSerializer.h"
+#include "../EliteGraph/EGraph.h"
+#include "../EliteGraph/EGraphConnection.h"
+#include "../EliteGraph/ECompactGraph.h"
+#include "../EliteGridGraph/EGridGraph.h"
+#include "../EliteTerrainGridGraph/ETerrainGridGraph.h"
+#include "../EliteTerrainGridGraph/ETerrainGraphNode.h"
+#include "../EliteNavGraph/ENavGraph.h"
+#include "../EliteNavGraph/ENavGraphNode.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(PLATFORM_ID) && (PLATFORM_ID == PLATFORM_WINDOWS)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace Elite;
+
+static_assert(sizeof(Vector2) == 2 * sizeof(float), "graph files store Vector2 as two floats");
+
+//== FILE LAYOUT ==
+enum class GraphFileType : uint32_t
+{
+	Graph = 0,
+	GridGraph = 1,
+	TerrainGridGraph = 2,
+	NavGraph = 3
+};
+
+enum GraphFileSection
+{
+	IsNodeValid, // uint8_t per node slot
+	NodePositions, // Vector2 per node slot
+	ConnectionOffsets, // int32_t per node slot + 1
+	ConnectionTargets, // int32_t per connection
+	ConnectionCosts, // float per connection
+	NodeTerrainTypes, // int32_t per node slot, terrain grid graphs only
+	NodeLineIndices, // int32_t per node slot, navgraphs only
+	Count
+};
+
+struct GraphFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	GraphFileType type;
+	uint32_t isDirectional;
+	int32_t nrOfNodeSlots;
+	int32_t amountNodes;
+	int32_t nrOfConnections;
+	int32_t columns; // grid graphs only
+	int32_t rows; // grid graphs only
+	uint32_t padding;
+	uint64_t sectionOffsets[GraphFileSection::Count]; // from the start of the file, 0 if the section is not there
+	uint64_t sectionSizes[GraphFileSection::Count];
+};
+
+static const char GRAPH_FILE_MAGIC[4] = { 'E', 'G', 'R', 'F' };
+static const uint64_t GRAPH_FILE_ALIGNMENT = 8;
+
+//== MAPPED FILE ==
+// Read-only view of a whole file, unmapped when the last CompactGraph using it is gone
+class MappedGraphFile final
+{
+public:
+	explicit MappedGraphFile(const std::string& filePath)
+	{
+#if defined(PLATFORM_ID) && (PLATFORM_ID == PLATFORM_WINDOWS)
+		m_hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_hFile == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(m_hFile, &fileSize) || fileSize.QuadPart == 0)
+			return;
+
+		m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_hMapping == nullptr)
+			return;
+
+		m_pData = static_cast<const char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_pData != nullptr)
+			m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		m_FileDescriptor = open(filePath.c_str(), O_RDONLY);
+		if (m_FileDescriptor < 0)
+			return;
+
+		struct stat fileStats {};
+		if (fstat(m_FileDescriptor, &fileStats) != 0 || fileStats.st_size == 0)
+			return;
+
+		void* pData = mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+		if (pData == MAP_FAILED)
+			return;
+
+		m_pData = static_cast<const char*>(pData);
+		m_Size = static_cast<size_t>(fileStats.st_size);
+#endif
+	}
+
+	~MappedGraphFile()
+	{
+#if defined(PLATFORM_ID) && (PLATFORM_ID == PLATFORM_WINDOWS)
+		if (m_pData != nullptr)
+			UnmapViewOfFile(m_pData);
+		if (m_hMapping != nullptr)
+			CloseHandle(m_hMapping);
+		if (m_hFile != INVALID_HANDLE_VALUE)
+			CloseHandle(m_hFile);
+#else
+		if (m_pData != nullptr)
+			munmap(const_cast<char*>(m_pData), m_Size);
+		if (m_FileDescriptor >= 0)
+			close(m_FileDescriptor);
+#endif
+	}
+
+	const char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_Size; }
+
+private:
+	const char* m_pData = nullptr;
+	size_t m_Size = 0;
+
+#if defined(PLATFORM_ID) && (PLATFORM_ID == PLATFORM_WINDOWS)
+	HANDLE m_hFile = INVALID_HANDLE_VALUE;
+	HANDLE m_hMapping = nullptr;
+#else
+	int m_FileDescriptor = -1;
+#endif
+
+	MappedGraphFile(const MappedGraphFile& other) = delete;
+	MappedGraphFile& operator=(const MappedGraphFile& other) = delete;
+};
+
+//== HELPERS ==
+static GraphFileType GetGraphFileType(const Graph& graph)
+{
+	if (dynamic_cast<const NavGraph*>(&graph) != nullptr)
+		return GraphFileType::NavGraph;
+	if (dynamic_cast<const TerrainGridGraph*>(&graph) != nullptr)
+		return GraphFileType::TerrainGridGraph;
+	if (dynamic_cast<const GridGraph*>(&graph) != nullptr)
+		return GraphFileType::GridGraph;
+	return GraphFileType::Graph;
+}
+
+static uint64_t AlignFileOffset(uint64_t offset)
+{
+	return (offset + GRAPH_FILE_ALIGNMENT - 1) / GRAPH_FILE_ALIGNMENT * GRAPH_FILE_ALIGNMENT;
+}
+
+// Checks the header, the bounds of every section and the node and connection arrays in O(V + E),
+// so neither Load nor a search on a mapped file can index outside the graph
+static bool IsValidGraphFile(const char* pData, size_t size)
+{
+	if (size < sizeof(GraphFileHeader))
+		return false;
+
+	const GraphFileHeader* pHeader = reinterpret_cast<const GraphFileHeader*>(pData);
+	if (memcmp(pHeader->magic, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC)) != 0 || pHeader->version != GraphSerializer::FILE_VERSION)
+		return false;
+	if (pHeader->nrOfNodeSlots < 0 || pHeader->nrOfConnections < 0)
+		return false;
+
+	const uint64_t nrOfSlots = static_cast<uint64_t>(pHeader->nrOfNodeSlots);
+	const uint64_t nrOfConnections = static_cast<uint64_t>(pHeader->nrOfConnections);
+	const uint64_t expectedSizes[GraphFileSection::Count] =
+	{
+		nrOfSlots * sizeof(uint8_t),
+		nrOfSlots * sizeof(Vector2),
+		(nrOfSlots + 1) * sizeof(int32_t),
+		nrOfConnections * sizeof(int32_t),
+		nrOfConnections * sizeof(float),
+		nrOfSlots * sizeof(int32_t),
+		nrOfSlots * sizeof(int32_t)
+	};
+
+	for (int section = 0; section < GraphFileSection::Count; ++section)
+	{
+		const uint64_t offset = pHeader->sectionOffsets[section];
+		const bool isOptional = section == GraphFileSection::NodeTerrainTypes || section == GraphFileSection::NodeLineIndices;
+		if (offset == 0 && isOptional)
+			continue;
+
+		if (offset % GRAPH_FILE_ALIGNMENT != 0 || pHeader->sectionSizes[section] != expectedSizes[section]
+			|| offset < sizeof(GraphFileHeader) || offset > size || expectedSizes[section] > size - offset)
+			return false;
+	}
+
+	const uint8_t* pIsNodeValid = reinterpret_cast<const uint8_t*>(pData + pHeader->sectionOffsets[GraphFileSection::IsNodeValid]);
+	const int32_t* pConnectionOffsets = reinterpret_cast<const int32_t*>(pData + pHeader->sectionOffsets[GraphFileSection::ConnectionOffsets]);
+	const int32_t* pConnectionTargets = reinterpret_cast<const int32_t*>(pData + pHeader->sectionOffsets[GraphFileSection::ConnectionTargets]);
+	if (pConnectionOffsets[0] != 0 || pConnectionOffsets[nrOfSlots] != pHeader->nrOfConnections)
+		return false;
+
+	// the connections of a node are [offset, next offset), only valid nodes have them and they only lead to valid nodes
+	int32_t amountNodes = 0;
+	for (int32_t nodeId = 0; nodeId < pHeader->nrOfNodeSlots; ++nodeId)
+	{
+		const int32_t connectionsBegin = pConnectionOffsets[nodeId];
+		const int32_t connectionsEnd = pConnectionOffsets[nodeId + 1];
+		if (connectionsEnd < connectionsBegin || connectionsEnd > pHeader->nrOfConnections)
+			return false;
+
+		if (pIsNodeValid[nodeId] == 0)
+		{
+			if (connectionsEnd != connectionsBegin)
+				return false;
+			continue;
+		}
+
+		++amountNodes;
+		for (int32_t connectionIdx = connectionsBegin; connectionIdx < connectionsEnd; ++connectionIdx)
+		{
+			const int32_t toNodeId = pConnectionTargets[connectionIdx];
+			if (toNodeId < 0 || toNodeId >= pHeader->nrOfNodeSlots || pIsNodeValid[toNodeId] == 0)
+				return false;
+		}
+	}
+
+	return amountNodes == pHeader->amountNodes;
+}
+
+static std::shared_ptr<const CompactGraph> CreateGraphView(const GraphFileHeader& header, const char* pData, std::shared_ptr<const void> pStorage)
+{
+	auto getSection = [&header, pData](GraphFileSection section) -> const void*
+		{
+			return header.sectionOffsets[section] == 0 ? nullptr : pData + header.sectionOffsets[section];
+		};
+
+	CompactGraph::ArrayView arrays{};
+	arrays.pIsNodeValid = static_cast<const unsigned char*>(getSection(GraphFileSection::IsNodeValid));
+	arrays.pNodePositions = static_cast<const Vector2*>(getSection(GraphFileSection::NodePositions));
+	arrays.pConnectionOffsets = static_cast<const int*>(getSection(GraphFileSection::ConnectionOffsets));
+	arrays.pConnectionTargets = static_cast<const int*>(getSection(GraphFileSection::ConnectionTargets));
+	arrays.pConnectionCosts = static_cast<const float*>(getSection(GraphFileSection::ConnectionCosts));
+	arrays.pNodeTerrainTypes = static_cast<const int*>(getSection(GraphFileSection::NodeTerrainTypes));
+	arrays.pNodeLineIndices = static_cast<const int*>(getSection(GraphFileSection::NodeLineIndices));
+
+	return std::make_shared<const CompactGraph>(header.isDirectional != 0, header.nrOfNodeSlots, header.amountNodes, header.nrOfConnections, arrays, std::move(pStorage));
+}
+
+//== SAVING ==
+bool GraphSerializer::Save(const Graph& graph, const std::string& filePath)
+{
+	const CompactGraph compactGraph = graph.BuildCompactView();
+	const CompactGraph::ArrayView& arrays = compactGraph.GetArrays();
+	const int nrOfSlots = compactGraph.GetNrOfNodeSlots();
+
+	GraphFileHeader header{};
+	memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC));
+	header.version = FILE_VERSION;
+	header.type = GetGraphFileType(graph);
+	header.isDirectional = graph.IsDirectional() ? 1 : 0;
+	header.nrOfNodeSlots = nrOfSlots;
+	header.amountNodes = compactGraph.GetAmountOfNodes();
+	header.nrOfConnections = compactGraph.GetAmountOfConnections();
+
+	if (const GridGraph* pGridGraph = dynamic_cast<const GridGraph*>(&graph))
+	{
+		header.columns = pGridGraph->GetColumns();
+		header.rows = pGridGraph->GetRows();
+	}
+
+	// the node specific data lives in the node objects, gather it per slot
+	std::vector<int32_t> terrainTypes{};
+	std::vector<int32_t> lineIndices{};
+	if (header.type == GraphFileType::TerrainGridGraph)
+	{
+		terrainTypes.resize(nrOfSlots, static_cast<int32_t>(TerrainType::Ground));
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+		{
+			if (const TerrainGraphNode* pNode = dynamic_cast<const TerrainGraphNode*>(compactGraph.GetNode(nodeId)))
+				terrainTypes[nodeId] = static_cast<int32_t>(pNode->GetTerrainType());
+		}
+	}
+	else if (header.type == GraphFileType::NavGraph)
+	{
+		lineIndices.resize(nrOfSlots, invalid_node_id);
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+		{
+			if (const NavGraphNode* pNode = dynamic_cast<const NavGraphNode*>(compactGraph.GetNode(nodeId)))
+				lineIndices[nodeId] = pNode->GetLineIndex();
+		}
+	}
+
+	const void* pSections[GraphFileSection::Count] =
+	{
+		arrays.pIsNodeValid,
+		arrays.pNodePositions,
+		arrays.pConnectionOffsets,
+		arrays.pConnectionTargets,
+		arrays.pConnectionCosts,
+		terrainTypes.empty() ? nullptr : terrainTypes.data(),
+		lineIndices.empty() ? nullptr : lineIndices.data()
+	};
+	const uint64_t sectionSizes[GraphFileSection::Count] =
+	{
+		nrOfSlots * sizeof(uint8_t),
+		nrOfSlots * sizeof(Vector2),
+		(nrOfSlots + 1) * sizeof(int32_t),
+		header.nrOfConnections * sizeof(int32_t),
+		header.nrOfConnections * sizeof(float),
+		terrainTypes.size() * sizeof(int32_t),
+		lineIndices.size() * sizeof(int32_t)
+	};
+
+	uint64_t offset = AlignFileOffset(sizeof(GraphFileHeader));
+	for (int section = 0; section < GraphFileSection::Count; ++section)
+	{
+		if (pSections[section] == nullptr)
+			continue;
+
+		header.sectionOffsets[section] = offset;
+		header.sectionSizes[section] = sectionSizes[section];
+		offset = AlignFileOffset(offset + sectionSizes[section]);
+	}
+
+	std::ofstream file{ filePath, std::ios::binary | std::ios::trunc };
+	if (!file)
+		return false;
+
+	const char padding[GRAPH_FILE_ALIGNMENT]{};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(GraphFileHeader));
+	uint64_t writtenSize = sizeof(GraphFileHeader);
+	for (int section = 0; section < GraphFileSection::Count; ++section)
+	{
+		if (pSections[section] == nullptr)
+			continue;
+
+		file.write(padding, header.sectionOffsets[section] - writtenSize);
+		file.write(static_cast<const char*>(pSections[section]), sectionSizes[section]);
+		writtenSize = header.sectionOffsets[section] + sectionSizes[section];
+	}
+
+	return file.good();
+}
+
+//== LOADING ==
+std::shared_ptr<const CompactGraph> GraphSerializer::LoadMapped(const std::string& filePath)
+{
+	std::shared_ptr<MappedGraphFile> pFile = std::make_shared<MappedGraphFile>(filePath);
+	if (pFile->GetData() == nullptr || !IsValidGraphFile(pFile->GetData(), pFile->GetSize()))
+		return nullptr;
+
+	const char* pData = pFile->GetData();
+	return CreateGraphView(*reinterpret_cast<const GraphFileHeader*>(pData), pData, std::move(pFile));
+}
+
+bool GraphSerializer::Load(const std::string& filePath, Graph& graph)
+{
+	std::shared_ptr<MappedGraphFile> pFile = std::make_shared<MappedGraphFile>(filePath);
+	if (pFile->GetData() == nullptr || !IsValidGraphFile(pFile->GetData(), pFile->GetSize()))
+		return false;
+
+	const GraphFileHeader& header = *reinterpret_cast<const GraphFileHeader*>(pFile->GetData());
+	const std::shared_ptr<const CompactGraph> pFileGraph = CreateGraphView(header, pFile->GetData(), pFile);
+	const int nrOfSlots = pFileGraph->GetNrOfNodeSlots();
+
+	if (pFileGraph->IsDirectional() != graph.IsDirectional())
+		return false;
+
+	// graphs that create their own nodes have to match the layout of the file
+	const GraphFileType graphType = GetGraphFileType(graph);
+	if (graphType == GraphFileType::GridGraph || graphType == GraphFileType::TerrainGridGraph)
+	{
+		const GridGraph& gridGraph = static_cast<const GridGraph&>(graph);
+		if ((header.type != GraphFileType::GridGraph && header.type != GraphFileType::TerrainGridGraph)
+			|| header.columns != gridGraph.GetColumns() || header.rows != gridGraph.GetRows() || nrOfSlots != graph.GetNrOfNodeSlots())
+			return false;
+
+		// the connections can only be added between cells that still have a node
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+		{
+			if (pFileGraph->IsNodeValid(nodeId) != graph.IsNodeValid(nodeId))
+				return false;
+		}
+	}
+	else if (graphType == GraphFileType::NavGraph)
+	{
+		if (header.type != GraphFileType::NavGraph || nrOfSlots != graph.GetNrOfNodeSlots())
+			return false;
+
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+		{
+			const NavGraphNode* pNode = static_cast<const NavGraphNode*>(graph.GetNode(nodeId));
+			if (pFileGraph->IsNodeValid(nodeId) != (pNode != nullptr)
+				|| (pNode != nullptr && pNode->GetLineIndex() != pFileGraph->GetNodeLineIndex(nodeId)))
+				return false;
+		}
+	}
+
+	graph.BeginEdit();
+
+	if (graphType == GraphFileType::Graph)
+	{
+		// add a node for every slot so the ids match the file, then free the slots that were empty
+		graph.Clear();
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+			graph.AddNode(new GraphNode(pFileGraph->GetNodePos(nodeId)));
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+		{
+			if (!pFileGraph->IsNodeValid(nodeId))
+				graph.RemoveNode(nodeId);
+		}
+	}
+	else
+	{
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+		{
+			if (graph.IsNodeValid(nodeId))
+				graph.RemoveAllConnectionsWithNode(nodeId);
+		}
+	}
+
+	if (graphType == GraphFileType::TerrainGridGraph && pFileGraph->HasTerrainTypes())
+	{
+		const TerrainGridGraph& terrainGraph = static_cast<const TerrainGridGraph&>(graph);
+		for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+			terrainGraph.SetNodeTerrainType(nodeId, pFileGraph->GetNodeTerrainType(nodeId));
+	}
+
+	for (int nodeId = 0; nodeId < nrOfSlots; ++nodeId)
+	{
+		// undirected graphs store every connection twice, AddConnection adds the opposite one again
+		bool isSelfConnectionMirror = false;
+		const int connectionsEnd = pFileGraph->GetConnectionsEnd(nodeId);
+		for (int connectionIdx = pFileGraph->GetConnectionsBegin(nodeId); connectionIdx < connectionsEnd; ++connectionIdx)
+		{
+			const int toNodeId = pFileGraph->GetConnectionTarget(connectionIdx);
+			if (!graph.IsDirectional())
+			{
+				if (toNodeId < nodeId)
+					continue;
+				if (toNodeId == nodeId)
+				{
+					isSelfConnectionMirror = !isSelfConnectionMirror;
+					if (!isSelfConnectionMirror)
+						continue;
+				}
+			}
+			graph.AddConnection(new GraphConnection(nodeId, toNodeId, pFileGraph->GetConnectionCost(connectionIdx)));
+		}
+	}
+
+	graph.EndEdit();
+	return true;
+}
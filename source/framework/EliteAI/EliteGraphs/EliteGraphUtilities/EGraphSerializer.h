@@ -0,0 +1,37 @@
+//*=================================================*/
+// EGraphSerializer.h: Binary graph files. Load rebuilds a mutable graph from a file, LoadMapped maps the file and
+// returns a read-only CompactGraph that points straight into the mapping.
+//*=================================================*/
+
+#pragma once
+#include <memory>
+#include <string>
+
+namespace Elite
+{
+	class Graph;
+	class CompactGraph;
+
+	// Saves graphs to a versioned binary file: a header followed by flat arrays with the node positions,
+	// the connections in compressed sparse row layout, their costs and (if present) terrain types and navmesh line indices
+	class GraphSerializer final
+	{
+	public:
+		static const unsigned int FILE_VERSION = 1;
+
+		static bool Save(const Graph& graph, const std::string& filePath);
+
+		// Files that are cut off, from another version or with connections to nodes that don't exist are rejected by both loads.
+
+		// Replaces the nodes and connections of the graph with the ones in the file.
+		// Grid graphs and navgraphs keep their own nodes, so the file has to be saved from a graph with the same layout.
+		static bool Load(const std::string& filePath, Graph& graph);
+
+		// Maps the file into memory and returns a read-only graph on top of it without copying anything,
+		// the node and connection arrays are read once to check them. Returns nullptr if the file can't be used.
+		static std::shared_ptr<const CompactGraph> LoadMapped(const std::string& filePath);
+
+	private:
+		GraphSerializer() = delete;
+	};
+}
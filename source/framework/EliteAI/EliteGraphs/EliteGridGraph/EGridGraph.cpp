@@ -17,7 +17,7 @@ GridGraph::GridGraph(
 	float costStraight /* = 1.f*/,
 	float costDiagonal /* = 1.5f */,
 	GraphNodeFactory* const pFactory, ConnectionCostCalculator* const pCostCalculator)
-	: Graph(isDirectionalGraph, pFactory)
+	: Graph(isDirectionalGraph, pFactory != nullptr ? pFactory : new PooledGraphNodeFactory<GraphNode>(), new PooledGraphConnectionFactory())
 	, m_NrOfColumns(columns)
 	, m_NrOfRows(rows)
 	, m_CellSize(cellSize)
@@ -26,6 +26,9 @@ GridGraph::GridGraph(
 	, m_DefaultCostDiagonal(costDiagonal)
 	, m_pCostCalculator(pCostCalculator)
 {
+	// cells get their connections removed and re-added all the time while editing, undirected grids find the
+	// connections into a cell through the mirrored ones leaving it, only directed grids need the incoming index
+	SetTrackIncomingConnections(IsDirectional());
 	InitializeGrid();
 }
 
@@ -36,13 +39,18 @@ GridGraph::~GridGraph()
 
 void GridGraph::InitializeGrid()
 {
+	BeginEdit();
+	ReserveNodes(m_NrOfRows * m_NrOfColumns);
+
 	// Create all nodes
+	const int nrOfNeighbors = m_IsConnectedDiagonally ? 8 : 4;
 	for (int r = 0; r < m_NrOfRows; ++r)
 	{
 		for (int c = 0; c < m_NrOfColumns; ++c)
 		{
 			const int idx = GetNodeId(c, r);
 			AddNodeAtIndex(CreateNode(GetNodePos(idx)), idx);
+			ReserveConnections(idx, nrOfNeighbors);
 		}
 	}
 
@@ -51,12 +59,17 @@ void GridGraph::InitializeGrid()
 	{
 		for (int c = 0; c < m_NrOfColumns; ++c)
 		{
-			AddConnectionsToAdjacentCells(c, r);
+			const int idx = GetNodeId(c, r);
+			AddConnectionsInDirections(idx, c, r, m_StraightDirections, true);
+			if (m_IsConnectedDiagonally)
+				AddConnectionsInDirections(idx, c, r, m_DiagonalDirections, true);
 		}
 	}
+
+	EndEdit();
 }
 
-void Elite::GridGraph::AddConnectionsInDirections(int idx, int col, int row, const std::vector<Elite::Vector2>& directions)
+void Elite::GridGraph::AddConnectionsInDirections(int idx, int col, int row, const std::vector<Elite::Vector2>& directions, bool isBuildingGrid)
 {
 	for (const Elite::Vector2& d : directions)
 	{
@@ -68,9 +81,12 @@ void Elite::GridGraph::AddConnectionsInDirections(int idx, int col, int row, con
 			int neighborIdx = neighborRow * m_NrOfColumns + neighborCol;
 			float connectionCost = CalculateConnectionCost(idx, neighborIdx);
 
-			if (!Graph::ConnectionExists(idx, neighborIdx)
+			// while building the grid, only a cell that was handled before can already be connected to this one
+			const bool canExist = !isBuildingGrid || (!IsDirectional() && neighborIdx < idx);
+
+			if ((!canExist || !Graph::ConnectionExists(idx, neighborIdx))
 				&& connectionCost < 100000) //Extra check for different terrain types
-				AddConnection(new GraphConnection(idx, neighborIdx, connectionCost));
+				AddConnection(CreateConnection(idx, neighborIdx, connectionCost));
 		}
 	}
 }
@@ -107,7 +123,7 @@ void GridGraph::AddConnectionsToAdjacentCells(int idx)
 		AddConnectionsInDirections(idx, col, row, m_DiagonalDirections);
 	}
 
-	OnGraphModified(false, true);
+	NotifyGraphModified(false, true);
 }
 
 Vector2 Elite::GridGraph::GetNodePos(int nodeId) const
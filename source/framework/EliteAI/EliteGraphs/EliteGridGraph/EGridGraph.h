@@ -45,7 +45,7 @@ namespace Elite
 		ConnectionCostCalculator* m_pCostCalculator = nullptr;
 
 		void InitializeGrid();
-		void AddConnectionsInDirections(int idx, int col, int row, const std::vector<Vector2>& directions);
+		void AddConnectionsInDirections(int idx, int col, int row, const std::vector<Vector2>& directions, bool isBuildingGrid = false);
 
 		virtual float CalculateConnectionCost(int fromIdx, int toIdx) const;
 		Vector2 CalculatePosition(int col, int row) const;
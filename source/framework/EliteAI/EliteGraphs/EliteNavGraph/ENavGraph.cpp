@@ -33,7 +33,8 @@ NavGraph::NavGraph(const std::vector<Polygon>& colliderShapes, float widthWorld,
 	CreateNavigationGraph();
 }
 
-NavGraph::NavGraph(const NavGraph& other): Graph(other)
+NavGraph::NavGraph(const NavGraph& other): Graph(other),
+	m_LineIdxToNodeId(other.m_LineIdxToNodeId)
 {
 }
 
@@ -50,7 +51,17 @@ std::shared_ptr<NavGraph> NavGraph::Clone()
 
 int NavGraph::GetNodeIdFromLineIndex(int lineIdx) const
 {
-	for (auto& pNode : m_pNodes)
+	//Use the lookup if the node it points to still belongs to this line, the graph can be edited after creation
+	if (lineIdx >= 0 && lineIdx < static_cast<int>(m_LineIdxToNodeId.size()))
+	{
+		const int nodeId = m_LineIdxToNodeId[lineIdx];
+		if (nodeId == invalid_node_id)
+			return invalid_node_id;
+		if (IsNodeValid(nodeId) && static_cast<NavGraphNode*>(GetNode(nodeId))->GetLineIndex() == lineIdx)
+			return nodeId;
+	}
+
+	for (auto& pNode : m_pActiveNodes)
 	{
 		if (reinterpret_cast<NavGraphNode*>(pNode)->GetLineIndex() == lineIdx)
 		{
@@ -81,7 +92,11 @@ void NavGraph::CreateNavigationGraph()
 
 		Elite::Vector2 center = (line->p2 + line->p1) / 2.0f;
 		auto pNode = new NavGraphNode(line->index,center);
-		AddNode(pNode);
+		const int nodeId = AddNode(pNode);
+
+		if (line->index >= static_cast<int>(m_LineIdxToNodeId.size()))
+			m_LineIdxToNodeId.resize(line->index + 1, invalid_node_id);
+		m_LineIdxToNodeId[line->index] = nodeId;
 	}
 
 	//2  Now that every node is created, connect the nodes that share the same triangle (for each triangle, ... )
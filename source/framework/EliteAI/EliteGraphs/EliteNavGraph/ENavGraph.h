@@ -20,6 +20,7 @@ namespace Elite
 	private:
 		//--- Datamembers ---
 		Polygon* m_pNavMeshPolygon = nullptr; //Polygon that represents navigation mesh
+		std::vector<int> m_LineIdxToNodeId{}; //Node on every line of the navigation mesh, filled while creating the graph
 
 		void CreateNavigationGraph();
 
@@ -11,7 +11,7 @@ using namespace Elite;
 TerrainGridGraph::TerrainGridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight, float costDiagonal)
 	:GridGraph(columns, rows, cellSize,
 		isDirectionalGraph, isConnectedDiagonally, costStraight, costDiagonal, 
-		new GraphNodeFactoryTemplate<TerrainGraphNode>(), new TerrainCostCalculator())
+		new PooledGraphNodeFactory<TerrainGraphNode>(), new TerrainCostCalculator())
 {
 }
 
@@ -0,0 +1,117 @@
+/*=============================================================================*/
+// EObjectPool.h: slab allocator that hands out objects of one type.
+// Memory is requested in slabs that grow in size, destroyed objects go on a free list
+// and get reused before a new slab is allocated.
+// The graphs pool their nodes and connections with it, but every node still owns its own adjacency vector
+// (and a second one for the incoming connections of a directed graph), so building a graph still allocates
+// once or twice per node that has connections.
+/*=============================================================================*/
+#ifndef ELITE_OBJECT_POOL
+#define	ELITE_OBJECT_POOL
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <functional>
+
+namespace Elite
+{
+	template<typename T>
+	class EObjectPool final
+	{
+	public:
+		//=== Constructors & Destructors
+		explicit EObjectPool(size_t firstSlabSize = 64) : m_NextSlabSize{ firstSlabSize > 0 ? firstSlabSize : 1 } {}
+		// Objects that are still alive are not destructed, only their memory is released
+		~EObjectPool() = default;
+
+		//=== Public Functions ===
+		template<typename... T_Args>
+		T* Create(T_Args&&... args)
+		{
+			return new (Allocate()) T(std::forward<T_Args>(args)...);
+		}
+
+		void Destroy(T* pObject)
+		{
+			if (pObject == nullptr)
+				return;
+
+			pObject->~T();
+			Slot* pSlot = reinterpret_cast<Slot*>(pObject);
+			pSlot->pNextFree = m_pFreeList;
+			m_pFreeList = pSlot;
+		}
+
+		// True if the object lives in one of the slabs of this pool
+		bool Owns(const void* pObject) const
+		{
+			// objects tend to be destroyed in bulk in allocation order, so try the last hit first
+			if (m_LastOwningSlab < m_Slabs.size() && IsInSlab(m_Slabs[m_LastOwningSlab], pObject))
+				return true;
+
+			for (size_t slabIdx = m_Slabs.size(); slabIdx-- > 0;)
+			{
+				if (IsInSlab(m_Slabs[slabIdx], pObject))
+				{
+					m_LastOwningSlab = slabIdx;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		size_t GetNrOfSlabs() const { return m_Slabs.size(); }
+
+	private:
+		union Slot
+		{
+			Slot* pNextFree;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		struct Slab
+		{
+			std::unique_ptr<Slot[]> pSlots;
+			size_t size;
+		};
+
+		//=== Datamembers ===
+		static constexpr size_t MAX_SLAB_SIZE = 1 << 16;
+
+		std::vector<Slab> m_Slabs{};
+		Slot* m_pFreeList = nullptr;
+		size_t m_NrOfUsedSlotsInLastSlab = 0;
+		size_t m_NextSlabSize;
+		mutable size_t m_LastOwningSlab = 0;
+
+		static bool IsInSlab(const Slab& slab, const void* pObject)
+		{
+			const Slot* pBegin = slab.pSlots.get();
+			return std::less_equal<const void*>{}(pBegin, pObject) && std::less<const void*>{}(pObject, pBegin + slab.size);
+		}
+
+		void* Allocate()
+		{
+			if (m_pFreeList != nullptr)
+			{
+				Slot* pSlot = m_pFreeList;
+				m_pFreeList = pSlot->pNextFree;
+				return pSlot;
+			}
+
+			if (m_Slabs.empty() || m_NrOfUsedSlotsInLastSlab == m_Slabs.back().size)
+			{
+				m_Slabs.push_back(Slab{ std::unique_ptr<Slot[]>(new Slot[m_NextSlabSize]), m_NextSlabSize });
+				m_NrOfUsedSlotsInLastSlab = 0;
+				m_NextSlabSize = std::min(m_NextSlabSize * 2, MAX_SLAB_SIZE);
+			}
+
+			return &m_Slabs.back().pSlots[m_NrOfUsedSlotsInLastSlab++];
+		}
+
+		EObjectPool(EObjectPool const&) = delete;
+		EObjectPool& operator=(EObjectPool const&) = delete;
+	};
+}
+#endif
@@ -5,6 +5,7 @@
 #include "framework/EliteInterfaces/EIApp.h"
 #include "projects/DecisionMaking/SmartAgent.h"
 #include "projects/Movement/SteeringBehaviors/SteeringHelpers.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EPathCache.h"
 #include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EPathSmoothing.h"
 
 //Forward declarations
@@ -60,6 +61,8 @@ private:
 
 	// --Graph--
 	Elite::NavGraph* m_pNavGraph = nullptr;
+	// repeated requests between the same triangles reuse their corridor
+	Elite::PathCache m_PathCache{};
 
 	// --Debug drawing information--
 	static bool sShowPolygon;
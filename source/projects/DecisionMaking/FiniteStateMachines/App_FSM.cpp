@@ -105,7 +105,7 @@ void App_FSM::Update(float deltaTime)
 		const Elite::MouseData& mouseData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eLeft);
 		const Elite::Vector2 mouseTarget = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
 			Elite::Vector2((float)mouseData.X, (float)mouseData.Y));
-		m_vPath = NavMeshPathfinding::FindPath(m_pPlayer->GetPosition(), mouseTarget, m_pNavGraph);
+		m_vPath = m_PathCache.FindPath(m_pPlayer->GetPosition(), mouseTarget, m_pNavGraph);
 
 		//Check if a path exist and move to the following point
 		if (m_vPath.size() > 0)
@@ -206,6 +206,7 @@ void App_FSM::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("Path cache: %.0f%% hits, %.2f ms saved", m_PathCache.GetStats().GetHitRate() * 100.f, m_PathCache.GetStats().savedMicroseconds / 1000.0);
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -42,6 +42,7 @@ void App_GraphTheory::Start()
 	m_pAgent->SetAutoOrient(true);
 
 	m_pGraph = new Graph(false);
+	m_pGraph->EnableSpatialIndex(10.f);
 	int id0 = m_pGraph->AddNode(new GraphNode({ 20,30 }));
 	int id1 = m_pGraph->AddNode(new GraphNode({ -10,-10 }));
 
@@ -5,6 +5,8 @@
 #include "App_PathfindingAStar.h"
 #include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAstar.h"
 #include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EBFS.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EJumpPointSearch.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EThetaStar.h"
 #include "projects/Movement/SteeringBehaviors/SteeringAgent.h"
 #include "projects/Movement/SteeringBehaviors/PathFollow/PathFollowSteeringBehavior.h"
 
@@ -13,6 +15,8 @@ using namespace Elite;
 //Destructor
 App_PathfindingAStar::~App_PathfindingAStar()
 {
+	SAFE_DELETE(m_pReplanner);
+	SAFE_DELETE(m_pPathRequests);
 	SAFE_DELETE(m_pTerrainGraph);
 
 	SAFE_DELETE(m_pAgent);
@@ -28,6 +32,8 @@ void App_PathfindingAStar::Start()
 
 	//Create Graph
 	MakeGridGraph();
+	m_pPathRequests = new PathRequestQueue(m_pTerrainGraph, m_heuristicFunction);
+	m_pReplanner = new DStarLite(m_pTerrainGraph, m_heuristicFunction);
 
 	//Create Agent
 	m_pPathFollowBehavior = new PathFollow();
@@ -73,10 +79,11 @@ void App_PathfindingAStar::Update(float deltaTime)
 	UpdateImGui();
 
 	//UPDATE/CHECK GRID HAS CHANGED
-	if (m_GraphEditor.UpdateGraph(m_pTerrainGraph))
+	if (m_GraphEditor.UpdateGraph(m_pTerrainGraph) && IsPathAffectedByGraphChanges())
 	{
-		CalculatePath();
+		ReplanPath();
 	}
+	UpdatePathRequest();
 
 	m_pAgent->Update(deltaTime);
 }
@@ -183,6 +190,10 @@ void App_PathfindingAStar::UpdateImGui()
 		ImGui::Checkbox("NodeNumbers", &m_bDrawNodeNumbers);
 		ImGui::Checkbox("Connections", &m_bDrawConnections);
 		ImGui::Checkbox("Connections Costs", &m_bDrawConnectionsCosts);
+		if (ImGui::Checkbox("Any-angle path", &m_bAnyAnglePath))
+		{
+			CalculatePath();
+		}
 		if (ImGui::Combo("", &m_SelectedHeuristic, "Manhattan\0Euclidean\0SqEuclidean\0Octile\0Chebyshev", 4))
 		{
 			switch (m_SelectedHeuristic)
@@ -207,6 +218,39 @@ void App_PathfindingAStar::UpdateImGui()
 		}
 		ImGui::Spacing();
 
+		/*Spacing*/ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing(); ImGui::Spacing();
+
+		ImGui::Text("BENCHMARKS");
+		ImGui::Spacing();
+
+		ImGui::Checkbox("Old A*", &m_bBenchmarkOldAStar);
+		if (ImGui::Button("A* terrain"))
+		{
+			RunAStarBenchmark();
+		}
+		for (const AStarBenchmarkResult& result : m_AStarBenchmarkResults)
+		{
+			ImGui::Text("%dx%d", result.size, result.size);
+			ImGui::Indent();
+			ImGui::Text("%.1f ms", result.searchMilliseconds);
+			if (result.referenceMilliseconds >= 0.f)
+				ImGui::Text("old %.1f ms", result.referenceMilliseconds);
+			ImGui::Unindent();
+		}
+		if (ImGui::Button("Grid build"))
+		{
+			RunGridConstructionBenchmark();
+		}
+		for (const GridConstructionBenchmarkResult& result : m_GridBenchmarkResults)
+		{
+			ImGui::Text("%dx%d", result.size, result.size);
+			ImGui::Indent();
+			ImGui::Text("%.1f ms", result.milliseconds);
+			ImGui::Text("%.0f ns/node", result.nanosecondsPerNode);
+			ImGui::Unindent();
+		}
+		ImGui::Spacing();
+
 		//End
 		ImGui::PopAllowKeyboardFocus();
 		ImGui::End();
@@ -222,21 +266,147 @@ void App_PathfindingAStar::CalculatePath()
 		&& m_endPathId != invalid_node_id
 		&& m_startPathId != m_endPathId)
 	{
-		//Select (uncomment) BFS Pathfinding or A* Pathfinding
+		//A* that runs a few expansions per frame, see UpdatePathRequest.
+		//For a path in one go, select (uncomment) BFS Pathfinding, A* Pathfinding or Jump Point Search (falls back to A* once terrain costs are painted)
 		//Elite::BFS pathfinder = BFS(m_pTerrainGraph);
-		auto pathfinder = AStar(m_pTerrainGraph, m_heuristicFunction);
-		Elite::GraphNode* const startNode = m_pTerrainGraph->GetNode(m_startPathId);
-		Elite::GraphNode* const endNode = m_pTerrainGraph->GetNode(m_endPathId);
-
-		m_vPath = pathfinder.FindPath(startNode, endNode);
-		std::cout << "New path calculated using " << typeid(pathfinder).name() << std::endl;
-		UpdateAgentPath(m_vPath);
+		//auto pathfinder = JumpPointSearch(m_pTerrainGraph, m_heuristicFunction);
+		//auto pathfinder = AStar(m_pTerrainGraph, m_heuristicFunction);
+		//m_vPath = pathfinder.FindPath(m_pTerrainGraph->GetNode(m_startPathId), m_pTerrainGraph->GetNode(m_endPathId));
+		m_pPathRequests->ReleaseRequest(m_PathRequestId);
+		if (m_bAnyAnglePath)
+		{
+			// Lazy Theta* in one go, the path only has the corners
+			m_PathRequestId = PathRequestQueue::INVALID_REQUEST_ID;
+			m_vPath = ThetaStar(m_pTerrainGraph).FindPath(m_pTerrainGraph->GetNode(m_startPathId), m_pTerrainGraph->GetNode(m_endPathId));
+			m_PathGraphVersion = m_pTerrainGraph->GetVersion();
+			UpdateAgentPath(m_vPath);
+			return;
+		}
+		m_pPathRequests->SetHeuristicFunction(m_heuristicFunction);
+		m_PathRequestId = m_pPathRequests->RequestPath(m_startPathId, m_endPathId);
 	}
 	else
 	{
 		std::cout << "No valid start and end node..." << std::endl;
+		m_pPathRequests->ReleaseRequest(m_PathRequestId);
+		m_PathRequestId = PathRequestQueue::INVALID_REQUEST_ID;
+		m_vPath.clear();
+		m_PathGraphVersion = m_pTerrainGraph->GetVersion();
+	}
+}
+
+void App_PathfindingAStar::UpdatePathRequest()
+{
+	m_pPathRequests->Update(PATH_EXPANSIONS_PER_FRAME);
+
+	switch (m_pPathRequests->GetStatus(m_PathRequestId))
+	{
+	case PathRequestStatus::Done:
+		// an edit during the search restarts it, so the path belongs to the current graph
+		m_pPathRequests->GetPath(m_PathRequestId, m_vPath);
+		m_PathGraphVersion = m_pTerrainGraph->GetVersion();
+		std::cout << "New path calculated" << std::endl;
+		UpdateAgentPath(m_vPath);
+		break;
+	case PathRequestStatus::NoPath:
+		std::cout << "No path found..." << std::endl;
 		m_vPath.clear();
+		m_PathGraphVersion = m_pTerrainGraph->GetVersion();
+		UpdateAgentPath(m_vPath);
+		break;
+	default:
+		// still pending or partial
+		return;
 	}
+
+	m_pPathRequests->ReleaseRequest(m_PathRequestId);
+	m_PathRequestId = PathRequestQueue::INVALID_REQUEST_ID;
+}
+
+void App_PathfindingAStar::ReplanPath()
+{
+	// a path that is still being searched restarts by itself when the graph changes
+	if (m_PathRequestId != PathRequestQueue::INVALID_REQUEST_ID || m_endPathId == invalid_node_id)
+		return;
+
+	const int agentNodeId = m_pTerrainGraph->GetNodeIdAtPosition(m_pAgent->GetPosition());
+	if (agentNodeId == invalid_node_id)
+	{
+		CalculatePath();
+		return;
+	}
+
+	if (m_bAnyAnglePath)
+	{
+		m_vPath = ThetaStar(m_pTerrainGraph).FindPath(m_pTerrainGraph->GetNode(agentNodeId), m_pTerrainGraph->GetNode(m_endPathId));
+		m_PathGraphVersion = m_pTerrainGraph->GetVersion();
+		UpdateAgentPath(m_vPath);
+		return;
+	}
+
+	// the search is kept between edits as long as the agent heads for the same goal
+	m_pReplanner->SetHeuristicFunction(m_heuristicFunction);
+	if (m_pReplanner->GetGoalNodeId() != m_endPathId)
+		m_pReplanner->Initialize(agentNodeId, m_endPathId);
+	else
+		m_pReplanner->SetStart(agentNodeId);
+
+	m_pReplanner->FindPath(m_vPath);
+	m_PathGraphVersion = m_pTerrainGraph->GetVersion();
+	std::cout << "Path repaired, " << m_pReplanner->GetNrOfExpandedNodes() << " nodes expanded" << std::endl;
+	UpdateAgentPath(m_vPath);
+}
+
+bool App_PathfindingAStar::IsPathAffectedByGraphChanges() const
+{
+	// any edit can block a straight line between the corners
+	if (m_bAnyAnglePath)
+		return true;
+
+	std::vector<GraphChange> changes{};
+	if (!m_pTerrainGraph->GetChangesSince(m_PathGraphVersion, changes))
+		return true;
+
+	auto isOnPath = [this](int fromNodeId, int toNodeId)
+		{
+			for (size_t i = 1; i < m_vPath.size(); ++i)
+			{
+				if (m_vPath[i - 1]->GetId() == fromNodeId && m_vPath[i]->GetId() == toNodeId)
+					return true;
+			}
+			return false;
+		};
+
+	// connections that got removed and added again (e.g. painting terrain) only matter if they got cheaper
+	std::map<std::pair<int, int>, float> removedCosts{};
+	for (const GraphChange& change : changes)
+	{
+		switch (change.type)
+		{
+		case GraphChangeType::ConnectionRemoved:
+			if (isOnPath(change.fromNodeId, change.toNodeId))
+				return true;
+			removedCosts[{ change.fromNodeId, change.toNodeId }] = change.cost;
+			break;
+		case GraphChangeType::ConnectionAdded:
+		{
+			auto removedIt = removedCosts.find({ change.fromNodeId, change.toNodeId });
+			if (removedIt == removedCosts.end() || change.cost < removedIt->second)
+				return true;
+			break;
+		}
+		case GraphChangeType::NodeRemoved:
+			for (const GraphNode* const pNode : m_vPath)
+			{
+				if (pNode->GetId() == change.fromNodeId)
+					return true;
+			}
+			break;
+		default:
+			return true;
+		}
+	}
+	return false;
 }
 
 void App_PathfindingAStar::UpdateAgentPath(const std::vector<Elite::GraphNode*>& path)
@@ -254,3 +424,31 @@ void App_PathfindingAStar::UpdateAgentPath(const std::vector<Elite::GraphNode*>&
 		m_pAgent->SetPosition(pathPositions[0]);
 	}
 }
+
+void App_PathfindingAStar::RunAStarBenchmark()
+{
+	m_AStarBenchmarkResults.clear();
+	for (int size : GraphBenchmark::SIZES)
+	{
+		// the old search is quadratic, it would run for minutes on the largest grid
+		const bool runOldAStar = m_bBenchmarkOldAStar && size <= 500;
+		const AStarBenchmarkResult result = GraphBenchmark::BenchmarkAStar(size, runOldAStar);
+		m_AStarBenchmarkResults.push_back(result);
+
+		std::cout << "A* on a " << size << "x" << size << " terrain grid: " << result.searchMilliseconds << " ms, " << result.pathLength << " nodes";
+		if (runOldAStar)
+			std::cout << ", old A*: " << result.referenceMilliseconds << " ms" << (result.isSamePathCost ? "" : " (different path cost!)");
+		std::cout << std::endl;
+	}
+}
+
+void App_PathfindingAStar::RunGridConstructionBenchmark()
+{
+	m_GridBenchmarkResults.clear();
+	for (int size : GraphBenchmark::SIZES)
+	{
+		const GridConstructionBenchmarkResult result = GraphBenchmark::BenchmarkGridConstruction(size);
+		m_GridBenchmarkResults.push_back(result);
+		std::cout << "Building a " << size << "x" << size << " grid: " << result.milliseconds << " ms, " << result.nanosecondsPerNode << " ns per node" << std::endl;
+	}
+}
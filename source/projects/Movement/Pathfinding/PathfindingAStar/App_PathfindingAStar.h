@@ -8,6 +8,9 @@
 #include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphEditor.h"
 #include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphRenderer.h"
 #include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EHeuristic.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EDStarLite.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EPathRequestQueue.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphBenchmark.h"
 
 //Forward declerations
 class SteeringAgent;
@@ -44,6 +47,15 @@ private:
 	int m_startPathId = invalid_node_id;
 	int m_endPathId = invalid_node_id;
 	std::vector<Elite::GraphNode*> m_vPath;
+	unsigned long long m_PathGraphVersion = 0;
+	// the path is searched over several frames, the previous one stays until the new one is done
+	static const int PATH_EXPANSIONS_PER_FRAME = 100;
+	Elite::PathRequestQueue* m_pPathRequests = nullptr;
+	int m_PathRequestId = Elite::PathRequestQueue::INVALID_REQUEST_ID;
+	// repairs the path from the agent when the grid is edited
+	Elite::DStarLite* m_pReplanner = nullptr;
+	// Lazy Theta*, the agent walks straight lines between the corners instead of through every cell
+	bool m_bAnyAnglePath = false;
 
 	//Editor and Visualisation
 	Elite::GraphEditor m_GraphEditor{};
@@ -58,6 +70,11 @@ private:
 	int m_SelectedHeuristic = 4;
 	Elite::Heuristic m_heuristicFunction = Elite::HeuristicFunctions::Chebyshev;
 
+	//Benchmarks, the old A* takes minutes on the large grids so it only runs when asked for
+	bool m_bBenchmarkOldAStar = false;
+	std::vector<Elite::AStarBenchmarkResult> m_AStarBenchmarkResults{};
+	std::vector<Elite::GridConstructionBenchmarkResult> m_GridBenchmarkResults{};
+
 	//Steering agent 
 	SteeringAgent* m_pAgent = nullptr;
 	PathFollow* m_pPathFollowBehavior = nullptr;
@@ -66,7 +83,12 @@ private:
 	void MakeGridGraph();
 	void UpdateImGui();
 	void CalculatePath();
+	void UpdatePathRequest();
+	void ReplanPath();
+	bool IsPathAffectedByGraphChanges() const;
 	void UpdateAgentPath(const std::vector<Elite::GraphNode*>& path);
+	void RunAStarBenchmark();
+	void RunGridConstructionBenchmark();
 
 	//C++ make the class non-copyable
 	App_PathfindingAStar(const App_PathfindingAStar&) = delete;
@@ -0,0 +1,40 @@
+#include "stdafx.h"
+
+#include "FlowFieldFollowSteeringBehavior.h"
+#include "../SteeringAgent.h"
+
+FlowFieldFollow::FlowFieldFollow()
+{
+	m_pArrive = new Arrive();
+	m_pArrive->SetTargetRadius(0.5f);
+}
+
+FlowFieldFollow::~FlowFieldFollow()
+{
+	SAFE_DELETE(m_pArrive);
+}
+
+SteeringOutput FlowFieldFollow::CalculateSteering(float deltaT, SteeringAgent* const pAgent)
+{
+	if (m_pFlowField == nullptr)
+		return SteeringOutput{};
+
+	const int nodeId = m_pFlowField->GetNodeIdAtPosition(pAgent->GetPosition());
+	if (m_pFlowField->IsGoal(nodeId))
+	{
+		//Inside the goal cell, settle on its centre
+		m_pArrive->SetTarget(m_pFlowField->GetGraph()->GetNodePos(nodeId));
+		return m_pArrive->CalculateSteering(deltaT, pAgent);
+	}
+
+	//Zero outside the field and on cells that can't reach the goal
+	SteeringOutput steering = {};
+	steering.LinearVelocity = m_pFlowField->GetDirection(nodeId) * pAgent->GetMaxLinearSpeed();
+
+	if (pAgent->GetDebugRenderingEnabled())
+	{
+		DEBUGRENDERER2D->DrawDirection(pAgent->GetPosition(), steering.LinearVelocity, 5.f, Elite::Color(0, 1, 0), 0.4f);
+	}
+
+	return steering;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "../Steering/SteeringBehaviors.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EFlowField.h"
+
+//Follows the directions of a flow field and arrives at the goal cell, all agents that go to the same goal can share one field
+class FlowFieldFollow : public ISteeringBehavior
+{
+public:
+	FlowFieldFollow();
+	virtual ~FlowFieldFollow();
+	//The field is not owned, it has to outlive the behavior
+	void SetFlowField(const Elite::FlowField* pFlowField) { m_pFlowField = pFlowField; }
+	SteeringOutput CalculateSteering(float deltaT, SteeringAgent* const pAgent) override;
+
+private:
+	const Elite::FlowField* m_pFlowField = nullptr;
+	Arrive* m_pArrive = nullptr;
+};